@@ -252,11 +252,20 @@ struct Game
         ////////// Draw
         Renderer::clearColor();
 
+        // Asteroids keep their jagged look, drawCircle() is always round
         for (auto& a : asteroids)
-        { Renderer2D::drawCircle(a.pos, a.radius, false, ColorRGBAf::white(), a.segmentCount); }
+        {
+            Vector<Vector2f> points;
+            for (int i = 0; i < a.segmentCount; i++)
+            {
+                const float angle = 3.1415926f * 2.f * float(i) / float(a.segmentCount);
+                points.push_back(a.pos + Vector2f(std::cos(angle), std::sin(angle)) * a.radius);
+            }
+            Renderer2D::drawPolygon(points, false, ColorRGBAf::white());
+        }
 
         for (auto& p : projectiles)
-        { Renderer2D::drawCircle(p.pos, config.projectileSize, true, ColorRGBAf::yellow(), 5); }
+        { Renderer2D::drawCircle(p.pos, config.projectileSize, true, ColorRGBAf::yellow()); }
 
         if (!gameOver)
         {
@@ -1,12 +1,43 @@
 
 #version 330 core
-in  vec2 fragTexCoords;
-in  vec4 fragColor;
-out vec4 outColor;
+in      vec2 fragTexCoords;
+in      vec4 fragColor;
+flat in int  fragTexIndex;
+out     vec4 outColor;
 
-uniform sampler2D image;
+// Renderer2D binds up to 16 textures per batch, fragTexIndex picks one.
+// This used to be a single sampler2D image. Custom shaders can keep it, they're drawn with one texture in slot 0.
+uniform sampler2D images[16];
+
+// GLSL 3.30 can only index sampler arrays with constants.
+// Gradients are taken outside the switch so mipmapping still works.
+vec4 sampleImage(vec2 uv)
+{
+    vec2 dx = dFdx(uv);
+    vec2 dy = dFdy(uv);
+    switch (fragTexIndex)
+    {
+        case  0: return textureGrad(images[0], uv, dx, dy);
+        case  1: return textureGrad(images[1], uv, dx, dy);
+        case  2: return textureGrad(images[2], uv, dx, dy);
+        case  3: return textureGrad(images[3], uv, dx, dy);
+        case  4: return textureGrad(images[4], uv, dx, dy);
+        case  5: return textureGrad(images[5], uv, dx, dy);
+        case  6: return textureGrad(images[6], uv, dx, dy);
+        case  7: return textureGrad(images[7], uv, dx, dy);
+        case  8: return textureGrad(images[8], uv, dx, dy);
+        case  9: return textureGrad(images[9], uv, dx, dy);
+        case 10: return textureGrad(images[10], uv, dx, dy);
+        case 11: return textureGrad(images[11], uv, dx, dy);
+        case 12: return textureGrad(images[12], uv, dx, dy);
+        case 13: return textureGrad(images[13], uv, dx, dy);
+        case 14: return textureGrad(images[14], uv, dx, dy);
+        case 15: return textureGrad(images[15], uv, dx, dy);
+    }
+    return vec4(1.0);
+}
 
 void main()
 {
-    outColor = fragColor * texture(image, vec2(fragTexCoords.x, fragTexCoords.y));
+    outColor = fragColor * sampleImage(vec2(fragTexCoords.x, fragTexCoords.y));
 }
\ No newline at end of file
@@ -1,16 +1,28 @@
 
 #version 330 core
-layout (location = 0) in vec4 vertex;
-layout (location = 1) in vec4 color;
+// Matches Renderer2D::PrimVert, and Renderer2D::WrapVert which has float texCoords.
+//
+// Custom Renderer2D shaders written for the old inputs have to be updated:
+//   layout (location = 0) in vec4 vertex; // xy = position, zw = uvs
+//   layout (location = 1) in vec4 color;
+// becomes pos at location 0, texCoords at 1 and color at 2, like below.
+// Renderer2D logs an error for shaders that still declare vertex.
+// texIndex can be left out, custom shaders only get texture slot 0.
+layout (location = 0) in vec2  pos;
+layout (location = 1) in vec2  texCoords; // unorm16
+layout (location = 2) in vec4  color;     // RGBA8
+layout (location = 3) in float texIndex;  // Texture slot in the batch, see 2d.frag
 
-out vec2 fragTexCoords;
-out vec4 fragColor;
+out      vec2 fragTexCoords;
+out      vec4 fragColor;
+flat out int  fragTexIndex;
 
 uniform mat4 projection;
 
 void main()
 {
-    gl_Position   = projection * vec4(vertex.x, vertex.y, 0.0, 1.0);
-    fragTexCoords = vec2(vertex.z, vertex.w);
+    gl_Position   = projection * vec4(pos, 0.0, 1.0);
+    fragTexCoords = texCoords;
     fragColor     = color;
+    fragTexIndex  = int(texIndex);
 }
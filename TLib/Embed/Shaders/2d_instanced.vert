@@ -0,0 +1,32 @@
+#version 330 core
+// One instance per sprite, drawn as a 4 vertex triangle strip
+layout (location = 0) in vec2  pos;      // Top left of the sprite
+layout (location = 1) in vec2  size;
+layout (location = 2) in vec2  origin;   // Rotation origin, relative to pos
+layout (location = 3) in float rotation; // Radians
+layout (location = 4) in vec4  uvRect;   // Top left uv, bottom right uv
+layout (location = 5) in vec4  color;
+layout (location = 6) in float texIndex; // Texture slot in the batch, see 2d.frag
+
+out      vec2 fragTexCoords;
+out      vec4 fragColor;
+flat out int  fragTexIndex;
+
+uniform mat4 projection;
+
+void main()
+{
+    // (0, 0) (1, 0) (0, 1) (1, 1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 local  = corner * size - origin;
+
+    float s = sin(rotation);
+    float c = cos(rotation);
+    vec2 world = pos + origin + vec2(local.x * c - local.y * s,
+                                     local.x * s + local.y * c);
+
+    gl_Position   = projection * vec4(world, 0.0, 1.0);
+    fragTexCoords = mix(uvRect.xy, uvRect.zw, corner);
+    fragColor     = color;
+    fragTexIndex  = int(texIndex);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+in      vec2  fragLocal;
+in      vec4  fragColor;
+flat in vec2  fragHalfSize;
+flat in float fragRadius;
+flat in float fragThickness;
+out     vec4  outColor;
+
+// Signed distance to a box with rounded corners, negative inside.
+// Circles and capsules are boxes rounded by half their smaller side.
+float roundedBox(vec2 p, vec2 halfSize, float radius)
+{
+    vec2 q = abs(p) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main()
+{
+    float dist = roundedBox(fragLocal, fragHalfSize, fragRadius);
+
+    // Outlines are a band inside the edge
+    if (fragThickness > 0.0)
+    { dist = abs(dist + fragThickness * 0.5) - fragThickness * 0.5; }
+
+    // Fades over about a pixel at any zoom
+    float alpha = clamp(0.5 - dist / max(fwidth(dist), 1e-5), 0.0, 1.0);
+    if (alpha <= 0.0) { discard; }
+
+    outColor = vec4(fragColor.rgb, fragColor.a * alpha);
+}
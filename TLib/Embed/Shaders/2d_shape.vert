@@ -0,0 +1,36 @@
+#version 330 core
+// One instance per shape, laid out like a sprite instance, see Renderer2D::shape_batch()
+layout (location = 0) in vec2  pos;      // Top left of the quad
+layout (location = 1) in vec2  size;     // Of the quad, the shape plus padding for antialiasing
+layout (location = 2) in vec2  origin;   // Rotation origin, relative to pos
+layout (location = 3) in float rotation; // Radians
+layout (location = 4) in vec4  params;   // Corner radius, outline thickness and padding, over half the quad's smaller side
+layout (location = 5) in vec4  color;
+
+out      vec2  fragLocal;     // From the center of the shape
+out      vec4  fragColor;
+flat out vec2  fragHalfSize;
+flat out float fragRadius;
+flat out float fragThickness; // 0 if filled
+
+uniform mat4 projection;
+
+void main()
+{
+    // (0, 0) (1, 0) (0, 1) (1, 1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 local  = corner * size - origin;
+
+    float s = sin(rotation);
+    float c = cos(rotation);
+    vec2 world = pos + origin + vec2(local.x * c - local.y * s,
+                                     local.x * s + local.y * c);
+
+    float unit    = min(size.x, size.y) * 0.5;
+    gl_Position   = projection * vec4(world, 0.0, 1.0);
+    fragLocal     = (corner - 0.5) * size;
+    fragColor     = color;
+    fragHalfSize  = size * 0.5 - params.z * unit;
+    fragRadius    = params.x * unit;
+    fragThickness = params.y * unit;
+}
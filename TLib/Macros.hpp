@@ -39,7 +39,7 @@ if( !(x) ) \
     << '\n' << str << '\n'; abort(); \
 }
 #else
-#define ASSERTMSG(x) ((void)0);
+#define ASSERTMSG(x, str) ((void)0);
 #endif
 
 #if defined(TLIB_DEBUG) && !defined(TLIB_DISABLE_ASSERT_WARN)
@@ -191,7 +191,7 @@ public:
             verts.push_back(transformedVec);
         }
 
-        Renderer2D::drawLines(verts, convColor(color), GLDrawMode::LineLoop, layer);
+        Renderer2D::drawPolygon(verts, false, convColor(color), layer);
     }
 
     void DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override
@@ -205,17 +205,17 @@ public:
             verts.push_back(transformedVec);
         }
 
-        Renderer2D::drawLines(verts, convColor(color), GLDrawMode::TriangleFan, layer);
+        Renderer2D::drawPolygon(verts, true, convColor(color), layer);
     }
 
     void DrawCircle(const b2Vec2& center, float radius, const b2Color& color) override
     {
-        Renderer2D::drawCircle(convVec(center), radius * scale, layer, convColor(color));
+        Renderer2D::drawCircle(convVec(center), radius * scale, false, convColor(color), layer);
     }
 
     void DrawSolidCircle(const b2Vec2& center, float radius, const b2Vec2& axis, const b2Color& color) override
     {
-        Renderer2D::drawCircle(convVec(center), radius * scale, layer, convColor(color), true);
+        Renderer2D::drawCircle(convVec(center), radius * scale, true, convColor(color), layer);
     }
 
     void DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color) override
@@ -226,6 +226,11 @@ public:
     void DrawTransform(const b2Transform& xf) override
     { return; }
 
+    // size is in pixels
     void DrawPoint(const b2Vec2& p, float size, const b2Color& color) override
-    { return; };
+    {
+        const Vector2f pos = convVec(p);
+        Renderer2D::drawRect(Rectf(pos - Vector2f(size, size) / 2.f, Vector2f(size, size)), 0.f, true, convColor(color),
+                             Renderer2D::OriginCenter, layer + 1);
+    }
 };
\ No newline at end of file
@@ -45,6 +45,7 @@ public:
         if (!created()) { create(); }
         bind();
         texture.bind();
+        texture.setRenderTarget(true);
         texturePtr  = &texture;
         currentType = type;
         GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, static_cast<GLenum>(type), GL_TEXTURE_2D, texture.handle(), 0));
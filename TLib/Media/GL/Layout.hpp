@@ -39,9 +39,11 @@ namespace TLib
         uint8_t  _size = 0;
         GLType   _type = GLType::Unknown;
         uint32_t _divisor = 0;
+        bool     _normalized = false; // Integer types are mapped to [0, 1] ([-1, 1] if signed) when read as floats
     
     public:
-        constexpr Attribute(uint8_t size, GLType type, uint32_t divisor = 0) : _size{ size }, _type{ type }, _divisor{ divisor }
+        constexpr Attribute(uint8_t size, GLType type, uint32_t divisor = 0, bool normalized = false)
+            : _size{ size }, _type{ type }, _divisor{ divisor }, _normalized{ normalized }
         {
             // Attributes can't have more than 4 components
             ASSERT(size <= 4);
@@ -49,11 +51,15 @@ namespace TLib
     
         inline Attribute& setDivisor(uint32_t v)
         { _divisor = v; return *this; }
+
+        inline Attribute& setNormalized(bool v)
+        { _normalized = v; return *this; }
     
         [[nodiscard]] inline uint32_t sizeBytes() const { return _size * glTypeSizeMap[_type]; }
         [[nodiscard]] inline uint8_t  size()      const { return _size; }
         [[nodiscard]] inline GLType   type()      const { return _type; }
         [[nodiscard]] inline uint32_t divisor()   const { return _divisor; }
+        [[nodiscard]] inline bool     normalized() const { return _normalized; }
     };
     
     /**
@@ -133,9 +139,15 @@ namespace TLib
         [[maybe_unused]] constexpr static inline Attribute Bool () { return { 1, GLType::Bool  }; }
         [[maybe_unused]] constexpr static inline Attribute Float() { return { 1, GLType::Float }; }
         [[maybe_unused]] constexpr static inline Attribute Int  () { return { 1, GLType::Int   }; }
+        [[maybe_unused]] constexpr static inline Attribute UInt () { return { 1, GLType::UInt  }; }
         [[maybe_unused]] constexpr static inline Attribute Vec2f() { return { 2, GLType::Float }; }
         [[maybe_unused]] constexpr static inline Attribute Vec3f() { return { 3, GLType::Float }; }
         [[maybe_unused]] constexpr static inline Attribute Vec4f() { return { 4, GLType::Float }; }
+
+        // Normalized, read as floats in [0, 1]. Vec4ubNorm fits a ColorRGBAi, Vec2usNorm fits packed uvs
+        [[maybe_unused]] constexpr static inline Attribute Vec4ubNorm() { return { 4, GLType::UByte,  0, true }; }
+        [[maybe_unused]] constexpr static inline Attribute Vec2usNorm() { return { 2, GLType::UShort, 0, true }; }
+        [[maybe_unused]] constexpr static inline Attribute Vec4usNorm() { return { 4, GLType::UShort, 0, true }; }
     
         [[maybe_unused]] static inline Layout Mat3f() { return { Vec3f(), 3 }; }
         [[maybe_unused]] static inline Layout Mat4f() { return { Vec4f(), 4 }; }
@@ -125,6 +125,10 @@ public:
     bool created() const
     { return glHandle != 0; }
 
+    [[nodiscard]]
+    GLuint handle() const
+    { return glHandle; }
+
     void bind()
     {
         ASSERTMSG(created(), "Forgot to call shader::create()");
@@ -282,6 +286,15 @@ public:
         glUniformBlockBinding(glHandle, uniformIndex, index);
     }
 
+    template <typename ContainerType>
+    void setIntArray(const String& name, const ContainerType& value, size_t count)
+    {
+        bind();
+        auto loc = getUniformLocation(name); if (loc < 0) { return; }
+        ASSERT(value.size() > 0);
+        GL_CHECK(glUniform1iv(loc, count, &value[0]));
+    }
+
     template <typename ContainerType>
     void setMat4fArray(const String& name, const ContainerType& value, size_t count)
     {
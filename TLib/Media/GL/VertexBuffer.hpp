@@ -14,6 +14,28 @@ struct VertexBuffer : IBuffer
         GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(T) * data.size(), data.data(), static_cast<GLenum>(accessType)));
     }
 
+    // Allocates uninitialized storage. Calling this again orphans the old storage.
+    void allocate(size_t sizeBytes, AccessType accessType)
+    {
+        bind();
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeBytes, NULL, static_cast<GLenum>(accessType)));
+    }
+
+    // Call unmap() when you're done writing
+    void* mapRange(size_t offset, size_t sizeBytes, GLbitfield access)
+    {
+        bind();
+        void* ptr = nullptr;
+        GL_CHECK(ptr = glMapBufferRange(GL_ARRAY_BUFFER, offset, sizeBytes, access));
+        return ptr;
+    }
+
+    void unmap()
+    {
+        bind();
+        GL_CHECK(glUnmapBuffer(GL_ARRAY_BUFFER));
+    }
+
     void bind()
     {
         ASSERT(created());
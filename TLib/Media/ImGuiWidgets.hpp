@@ -88,6 +88,45 @@ bool imguiEnumCombo(const char* name, EnumType* value)
     return ret;
 }
 
+// Renderer2D::getStats() of the last frame, as a collapsing section of the current window
+void drawRenderer2DStats()
+{
+    if (!ImGui::CollapsingHeader("Renderer2D")) { return; }
+
+    const Renderer2DStats& stats = Renderer2D::getStats();
+    ImGui::Text(fmt::format("Commands           : {}", stats.commands).c_str());
+    ImGui::Text(fmt::format("Flushes            : {}", stats.flushes).c_str());
+    ImGui::Text(fmt::format("Batches            : {}", stats.batches).c_str());
+    for (auto reason : magic_enum::enum_values<Renderer2DBatchBreak>())
+    {
+        if (reason == Renderer2DBatchBreak::Count) { continue; }
+        ImGui::Text(fmt::format("  {:<17}: {}", magic_enum::enum_name(reason), stats.breakCount(reason)).c_str());
+    }
+    ImGui::Text(fmt::format("Vertices           : {}", stats.vertices).c_str());
+    ImGui::Text(fmt::format("Indices            : {}", stats.indices).c_str());
+    ImGui::Text(fmt::format("Instances          : {}", stats.instances).c_str());
+    ImGui::Text(fmt::format("Auto atlased       : {}", stats.atlased).c_str());
+    ImGui::Text(fmt::format("Cached text        : {}", stats.cachedText).c_str());
+    ImGui::Text(fmt::format("Cached shapes      : {}", stats.cachedShapes).c_str());
+    ImGui::Text(fmt::format("Uploaded           : {:.1f} KB", stats.bytesUploaded / 1024.0).c_str());
+    ImGui::Text(fmt::format("Sort               : {:.3f} ms", stats.sortMs).c_str());
+    ImGui::Text(fmt::format("Build              : {:.3f} ms", stats.buildMs).c_str());
+
+    if (ImGui::TreeNode("Batch breaks"))
+    {
+        ImGui::BeginChild("breaks", ImVec2(0, 200), true);
+        for (const Renderer2DBatchBreakInfo& b : stats.breakLog)
+        {
+            ImGui::Text(fmt::format("{:<10} layer {:<4} texture {:<4} shader {:<4} {}",
+                magic_enum::enum_name(b.reason), b.layer,
+                b.texture ? b.texture->handle() : 0, b.shader ? b.shader->handle() : 0,
+                magic_enum::enum_name(b.drawMode)).c_str());
+        }
+        ImGui::EndChild();
+        ImGui::TreePop();
+    }
+}
+
 String diagWindowName = "Diagnostics";
 // End with ImGui::End()
 void beginDiagWidgetExt(bool* p_open = NULL, ImGuiWindowFlags flags = 0)
@@ -159,6 +198,8 @@ void drawDiagWidget(FPSLimit* fpslimit = nullptr, bool* p_open = NULL, ImGuiWind
     ImGui::Text(fmt::format("VRAM Total Avail   : {} MB", sysq::kbToMb(vmeminfo.totalAvailable)).c_str());
     ImGui::Text(fmt::format("VRAM Current Avail : {} MB", sysq::kbToMb(vmeminfo.currentAvailable)).c_str());
 
+    drawRenderer2DStats();
+
     ImGui::End();
 }
 
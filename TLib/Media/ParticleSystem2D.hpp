@@ -0,0 +1,389 @@
+#pragma once
+
+#include <TLib/Media/Renderer2D.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <TLib/Containers/Array.hpp>
+#include <TLib/NonAssignable.hpp>
+#include <TLib/SIMD.hpp>
+#include <TLib/RNG.hpp>
+#include <initializer_list>
+
+// A value over the life of a particle, t goes from 0 when it's emitted to 1 when it dies.
+// Keys are interpolated linearly and have to be sorted by t.
+template <typename T>
+struct ParticleCurve2D
+{
+    struct Key
+    {
+        float t;
+        T     value;
+    };
+
+    Vector<Key> keys;
+
+    ParticleCurve2D() = default;
+    ParticleCurve2D(std::initializer_list<Key> init) : keys(init.begin(), init.end()) { }
+
+    [[nodiscard]] T sample(float t) const
+    {
+        ASSERT(!keys.empty());
+        if (t <= keys.front().t) { return keys.front().value; }
+        for (size_t i = 1; i < keys.size(); i++)
+        {
+            if (t > keys[i].t) { continue; }
+            const Key& a = keys[i - 1];
+            const Key& b = keys[i];
+            return lerp(a.value, b.value, (t - a.t) / std::max(b.t - a.t, 1e-6f));
+        }
+        return keys.back().value;
+    }
+
+private:
+    static float lerp(float a, float b, float t)
+    { return a + (b - a) * t; }
+
+    static ColorRGBAf lerp(const ColorRGBAf& a, const ColorRGBAf& b, float t)
+    { return { lerp(a.r, b.r, t), lerp(a.g, b.g, t), lerp(a.b, b.b, t), lerp(a.a, b.a, t) }; }
+};
+
+// Where and how ParticleSystem2D::emit() and burst() spawn particles. Ranges are picked from uniformly.
+struct ParticleEmitter2D
+{
+    Vector2f pos;
+    Vector2f spread      = { 0.f, 0.f };  // Half size of the box particles spawn in, around pos
+    float    angle       = 0.f;           // Direction particles are shot in, radians
+    float    angleSpread = 3.1415926f;    // Radians either side of angle
+    float    speedMin    = 50.f;          // World units per second
+    float    speedMax    = 100.f;
+    float    lifeMin     = 1.f;           // Seconds
+    float    lifeMax     = 2.f;
+    float    sizeMin     = 4.f;           // World units, scaled by ParticleSystem2DSettings::sizeOverLife
+    float    sizeMax     = 8.f;
+    float    rotationMin = 0.f;           // Radians
+    float    rotationMax = 0.f;
+    float    spinMin     = 0.f;           // Radians per second
+    float    spinMax     = 0.f;
+    float    rate        = 100.f;         // Particles per second, see ParticleSystem2D::emit()
+    float    pending     = 0.f;           // Fraction of a particle left over from the last emit()
+};
+
+// Shared by every particle of a ParticleSystem2D
+struct ParticleSystem2DSettings
+{
+    Texture*                    texture       = nullptr;          // nullptr for plain colored squares
+    Rectf                       srcrect;                          // In texels, empty for the whole texture
+    int                         layer         = Renderer2D::DefaultSpriteLayer;
+    uint32_t                    maxParticles  = 1024 * 64;        // New particles are dropped once this many are alive
+    Vector2f                    acceleration  = { 0.f, -100.f };  // Gravity and the like, world units per second squared
+    float                       drag          = 0.f;              // Fraction of the speed lost per second, about
+    ParticleCurve2D<float>      sizeOverLife  = { { 0.f, 1.f }, { 1.f, 1.f } };
+    ParticleCurve2D<ColorRGBAf> colorOverLife = { { 0.f, ColorRGBAf::white() }, { 1.f, ColorRGBAf::transparent() } };
+};
+
+/*
+Lots of short lived sprites, for effects. Particles are stored as one array per field and updated 4 at a time
+with SIMD, dead ones are swapped with the last live one so the arrays stay packed.
+draw() writes every particle into one Renderer2D draw command, instead of going through drawTexture().
+
+    ParticleSystem2D sparks;
+    sparks.create(settings);
+
+    // Every frame
+    sparks.emit(emitter, delta);
+    sparks.update(delta);
+    sparks.draw();
+    Renderer2D::render();
+
+The size and color curves are baked into tables by create(), call it again after changing them.
+*/
+struct ParticleSystem2D : NonCopyable
+{
+protected:
+    using PrimVert           = Renderer2D::PrimVert;
+    using SpriteInstanceData = Renderer2D::SpriteInstanceData;
+    using DrawCmd            = Renderer2D::DrawCmd;
+
+    // One array of each, indexed by particle
+    enum Stream
+    {
+        PosX, PosY,
+        VelX, VelY,
+        Age,     // 0 to 1 over the particle's life
+        InvLife, // 1 / seconds
+        Rotation,
+        Spin,
+        Size,
+        StreamCount
+    };
+
+    // The curves sampled at evenly spaced ages
+    static constexpr int curveSamples = 64;
+
+    // A group of 4 particles with dead lanes, see update()
+    struct DeadGroup
+    {
+        uint32_t first;
+        int      lanes;
+    };
+
+    ParticleSystem2DSettings          settings;
+    Array<Vector<float>, StreamCount> streams;
+    Array<float,      curveSamples>   sizeTable;
+    Array<ColorRGBAi, curveSamples>   colorTable;
+    Vector<DeadGroup>                 deadGroups;
+    uint32_t                          count    = 0;
+    uint32_t                          capacity = 0;
+    RNG                               rng;
+
+    inline float* stream(Stream s) { return streams[s].data(); }
+
+    // Particles stay packed at the front, the last live one takes the place of index
+    void remove(uint32_t index)
+    {
+        --count;
+        if (index == count) { return; }
+        for (Vector<float>& s : streams) { s[index] = s[count]; }
+    }
+
+    int curveIndex(float age) const
+    { return std::min(int(age * float(curveSamples - 1) + 0.5f), curveSamples - 1); }
+
+public:
+    ParticleSystem2D()  = default;
+    ~ParticleSystem2D() = default;
+
+    [[nodiscard]] inline uint32_t particleCount() const { return count; }
+    [[nodiscard]] inline uint32_t getCapacity()   const { return capacity; }
+    [[nodiscard]] inline const ParticleSystem2DSettings& getSettings() const { return settings; }
+
+    // Clears the particles
+    void create(const ParticleSystem2DSettings& newSettings = {})
+    {
+        settings = newSettings;
+        count    = 0;
+        capacity = settings.maxParticles;
+
+        // Rounded up so the last group of 4 can be loaded whole
+        for (Vector<float>& s : streams) { s.resize((size_t(capacity) + 3) & ~size_t(3), 0.f); }
+
+        for (int i = 0; i < curveSamples; i++)
+        {
+            const float t = float(i) / float(curveSamples - 1);
+            sizeTable[i]  = settings.sizeOverLife .keys.empty() ? 1.f       : settings.sizeOverLife.sample(t);
+            colorTable[i] = settings.colorOverLife.keys.empty() ? ColorRGBAi(255, 255, 255, 255)
+                                                                : settings.colorOverLife.sample(t).toRGBAi();
+        }
+    }
+
+    void clear()
+    { count = 0; }
+
+    // Spawns n particles at once, fewer if the system fills up
+    void burst(const ParticleEmitter2D& emitter, uint32_t n)
+    {
+        n = std::min(n, capacity - count);
+        for (uint32_t i = 0; i < n; i++, count++)
+        {
+            const float angle = emitter.angle + rng.randRangeReal(-emitter.angleSpread, emitter.angleSpread);
+            const float speed = rng.randRangeReal(emitter.speedMin, emitter.speedMax);
+
+            streams[PosX]    [count] = emitter.pos.x + rng.randRangeReal(-emitter.spread.x, emitter.spread.x);
+            streams[PosY]    [count] = emitter.pos.y + rng.randRangeReal(-emitter.spread.y, emitter.spread.y);
+            streams[VelX]    [count] = std::cos(angle) * speed;
+            streams[VelY]    [count] = std::sin(angle) * speed;
+            streams[Age]     [count] = 0.f;
+            streams[InvLife] [count] = 1.f / std::max(rng.randRangeReal(emitter.lifeMin, emitter.lifeMax), 1e-4f);
+            streams[Rotation][count] = rng.randRangeReal(emitter.rotationMin, emitter.rotationMax);
+            streams[Spin]    [count] = rng.randRangeReal(emitter.spinMin, emitter.spinMax);
+            streams[Size]    [count] = rng.randRangeReal(emitter.sizeMin, emitter.sizeMax);
+        }
+    }
+
+    // Spawns emitter.rate particles per second, carrying the fraction over in emitter.pending
+    void emit(ParticleEmitter2D& emitter, float delta)
+    {
+        emitter.pending += emitter.rate * delta;
+        const uint32_t n = uint32_t(std::max(emitter.pending, 0.f));
+        emitter.pending -= float(n);
+        burst(emitter, n);
+    }
+
+    // Moves, spins and ages every particle by delta seconds, and removes the ones that died
+    void update(float delta)
+    {
+        using namespace simd;
+        if (count == 0) { return; }
+
+        float* px   = stream(PosX);     float* py   = stream(PosY);
+        float* vx   = stream(VelX);     float* vy   = stream(VelY);
+        float* age  = stream(Age);      float* inv  = stream(InvLife);
+        float* rot  = stream(Rotation); float* spin = stream(Spin);
+
+        const Float4 dt   = Float4::set1(delta);
+        const Float4 ax   = Float4::set1(settings.acceleration.x * delta);
+        const Float4 ay   = Float4::set1(settings.acceleration.y * delta);
+        const Float4 damp = Float4::set1(1.f / (1.f + std::max(settings.drag, 0.f) * delta));
+        const Float4 one  = Float4::set1(1.f);
+
+        deadGroups.clear();
+        for (uint32_t i = 0; i < count; i += 4)
+        {
+            const Float4 nvx = (Float4::load(vx + i) + ax) * damp;
+            const Float4 nvy = (Float4::load(vy + i) + ay) * damp;
+            nvx.store(vx + i);
+            nvy.store(vy + i);
+            (Float4::load(px + i) + nvx * dt).store(px + i);
+            (Float4::load(py + i) + nvy * dt).store(py + i);
+            (Float4::load(rot + i) + Float4::load(spin + i) * dt).store(rot + i);
+
+            const Float4 nage = Float4::load(age + i) + Float4::load(inv + i) * dt;
+            nage.store(age + i);
+
+            // Lanes past count hold whatever was removed last
+            const int lanes = bits(nage >= one) & ((1 << std::min(count - i, 4u)) - 1);
+            if (lanes) { deadGroups.push_back({ i, lanes }); }
+        }
+
+        // Back to front, so the particle that fills a dead slot was updated already and is alive
+        for (auto it = deadGroups.rbegin(); it != deadGroups.rend(); ++it)
+        {
+            for (int l = 3; l >= 0; l--)
+            { if (it->lanes & (1 << l)) { remove(it->first + l); } }
+        }
+    }
+
+    // Queues every live particle as one Renderer2D draw command
+    void draw(bool cull = true)
+    {
+        using namespace simd;
+        ASSERT(Renderer2D::inited); // Forgot to call Renderer2D::init()
+        if (count == 0) { return; }
+
+        Texture&     texture   = settings.texture ? *settings.texture : Renderer2D::whiteTex;
+        const Rectf  srcrect   = settings.srcrect.width > 0.f && settings.srcrect.height > 0.f ?
+                                 settings.srcrect : Rectf(Vector2f(0.f, 0.f), Vector2f(texture.getSize()));
+        const bool   instanced = Renderer2D::instancingEnabled;
+
+        Renderer2D::CommandList& list = Renderer2D::target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture   = &texture;
+        cmd.shader    = instanced ? &Renderer2D::instanceShader : &Renderer2D::defaultShader;
+        cmd.layer     = settings.layer;
+        cmd.drawMode  = instanced ? GLDrawMode::TriangleStrip : GLDrawMode::Triangles;
+        cmd.instanced = instanced;
+        cmd.key       = Renderer2D::makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex  = instanced ? list.instances.size() : list.vertices.size();
+        cmd.indIndex  = list.indices.size();
+
+        if (instanced) { list.instances.reserve(list.instances.size() + count); }
+        else
+        {
+            list.vertices.reserve(list.vertices.size() + size_t(count) * 4);
+            list.indices .reserve(list.indices .size() + size_t(count) * 6);
+        }
+
+        const auto     uv = Renderer2D::getTextureUVs(texture, srcrect);
+        const uint16_t u0 = Renderer2D::toUnorm16(uv.first.x),  v0 = Renderer2D::toUnorm16(uv.first.y);
+        const uint16_t u1 = Renderer2D::toUnorm16(uv.second.x), v1 = Renderer2D::toUnorm16(uv.second.y);
+
+        const float* px   = stream(PosX);
+        const float* py   = stream(PosY);
+        const float* age  = stream(Age);
+        const float* rot  = stream(Rotation);
+        const float* size = stream(Size);
+
+        const bool   doCull     = cull && Renderer2D::cullingEnabled;
+        const Rectf& bounds     = Renderer2D::cullBounds;
+        const Float4 viewLeft   = Float4::set1(bounds.x);
+        const Float4 viewRight  = Float4::set1(bounds.getRight());
+        const Float4 viewTop    = Float4::set1(bounds.y);
+        const Float4 viewBottom = Float4::set1(bounds.getBottom());
+        const Float4 zero       = Float4::set1(0.f);
+        const Float4 half       = Float4::set1(0.5f);
+
+        uint32_t written = 0;
+        for (uint32_t i = 0; i < count; i += 4)
+        {
+            const uint32_t lanes = std::min(count - i, 4u);
+
+            // The curves are looked up per particle, the rest is done 4 at a time
+            alignas(16) float      scale[4] = {};
+            ColorRGBAi             color[4];
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                const int c = curveIndex(age[i + l]);
+                scale[l] = sizeTable[c];
+                color[l] = colorTable[c];
+            }
+
+            const Float4 x  = Float4::load(px + i), y = Float4::load(py + i);
+            const Float4 hs = Float4::load(size + i) * Float4::load(scale) * half;
+            Float4 sinr, cosr;
+            sincos(Float4::load(rot + i), sinr, cosr);
+
+            int visible = (1 << lanes) - 1;
+            if (doCull)
+            {
+                // Half extent of the rotated square's AABB
+                const Float4 ahs = max(hs, zero - hs);
+                const Float4 e   = ahs * (max(sinr, zero - sinr) + max(cosr, zero - cosr));
+                visible &= bits((x + e >= viewLeft) & (x - e <= viewRight) &
+                                (y + e >= viewTop)  & (y - e <= viewBottom));
+            }
+            if (!visible) { continue; }
+
+            if (instanced)
+            {
+                alignas(16) float h[4];
+                hs.store(h);
+                for (uint32_t l = 0; l < lanes; l++)
+                {
+                    if (!(visible & (1 << l))) { continue; }
+                    SpriteInstanceData& inst = list.instances.emplace_back();
+                    inst.pos      = Vector2f(px[i + l] - h[l], py[i + l] - h[l]);
+                    inst.size     = Vector2f(h[l] * 2.f, h[l] * 2.f);
+                    inst.origin   = Vector2f(h[l], h[l]);
+                    inst.rotation = rot[i + l];
+                    inst.uv[0]    = u0;
+                    inst.uv[1]    = v0;
+                    inst.uv[2]    = u1;
+                    inst.uv[3]    = v1;
+                    inst.color    = color[l];
+                    ++written;
+                }
+                continue;
+            }
+
+            // Same corners as Renderer2D::drawTextures()
+            const Float4 hc = hs * cosr, hn = hs * sinr;
+            alignas(16) float cx[4][4], cy[4][4];
+            (x - hc + hn).store(cx[0]); (y - hn - hc).store(cy[0]); // top left
+            (x + hc + hn).store(cx[1]); (y + hn - hc).store(cy[1]); // top right
+            (x - hc - hn).store(cx[2]); (y - hn + hc).store(cy[2]); // bottom left
+            (x + hc - hn).store(cx[3]); (y + hn + hc).store(cy[3]); // bottom right
+
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                if (!(visible & (1 << l))) { continue; }
+                const uint32_t first = written * 4;
+                list.vertices.push_back({ Vector2f(cx[0][l], cy[0][l]), u0, v0, color[l], 0 });
+                list.vertices.push_back({ Vector2f(cx[1][l], cy[1][l]), u1, v0, color[l], 0 });
+                list.vertices.push_back({ Vector2f(cx[2][l], cy[2][l]), u0, v1, color[l], 0 });
+                list.vertices.push_back({ Vector2f(cx[3][l], cy[3][l]), u1, v1, color[l], 0 });
+                for (const uint32_t ind : Renderer2D::sprite_indices) { list.indices.push_back(first + ind); }
+                ++written;
+            }
+        }
+
+        if (written == 0)
+        {
+            list.drawCmds.pop_back();
+            return;
+        }
+
+        cmd.posSize = instanced ? written : written * 4;
+        cmd.indSize = instanced ? 0       : written * 6;
+    }
+};
@@ -80,6 +80,9 @@ struct Window : NonAssignable
     SDL_SysWMinfo wm{};
     SDL_GLContext glContext = nullptr;
 
+    // Buffer swaps of every window so far, the renderers use it to tell frames apart
+    static inline uint64_t swapCount = 0;
+
     Window() = default;
    ~Window() { reset(); }
 
@@ -129,7 +132,7 @@ struct Window : NonAssignable
         SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
     }
 
-    void swap() { SDL_GL_SwapWindow(window); }
+    void swap() { SDL_GL_SwapWindow(window); ++swapCount; }
 
     void makeCurrent()
     {
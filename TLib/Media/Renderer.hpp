@@ -5,6 +5,7 @@
 #include <TLib/Media/GL/FrameBuffer.hpp>
 #include <TLib/Media/Resource/Texture.hpp>
 #include <TLib/Media/Resource/GPUVertexData.hpp>
+#include <TLib/Media/Platform/Window.hpp>
 #include <TLib/Media/Logging.hpp>
 #include <TLib/Macros.hpp>
 #include <TLib/Containers/Span.hpp>
@@ -42,8 +43,9 @@ struct DrawIndirectCmd
 struct Renderer
 {
 protected:
-    static inline size_t drawCalls = 0;
-    static inline bool   isCreated = false;
+    static inline size_t   drawCalls      = 0;
+    static inline bool     isCreated      = false;
+    static inline uint32_t framesInFlight = 1;
 
     static bool prepare(Shader& shader, GPUVertexData& mesh, const RenderState& state)
     {
@@ -146,6 +148,62 @@ public:
         mesh.unbind();
     }
 
+    /**
+     * Draws every instance in a range returned by GPUVertexData::mapStream().
+     * The mesh holds one record per instance (attributes with a divisor of 1),
+     * the vertex shader builds verticesPerInstance vertices from each one using gl_VertexID.
+     */
+    template <typename T>
+    static void drawInstanced(
+        Shader&                                 shader,
+        GPUVertexData&                          mesh,
+        const GPUVertexData::StreamRange<T>&    instances,
+        uint32_t                                verticesPerInstance,
+        const RenderState&                      state = RenderState())
+    {
+        if (!prepare(shader, mesh, state)) { return; }
+        mesh.setAttributeOffset(instances.baseVertex);
+
+        const GLenum glmode = static_cast<GLenum>(state.drawMode);
+        GL_CHECK(glDrawArraysInstanced(glmode, 0, verticesPerInstance, instances.vertexCount));
+
+        ++drawCalls;
+
+        mesh.unbind();
+    }
+
+    // Draws indiceCount indices starting at firstIndex. baseVertex is added to every index.
+    static void drawRange(
+        Shader&            shader,
+        GPUVertexData&     mesh,
+        uint32_t           indiceCount,
+        uint32_t           firstIndex,
+        uint32_t           baseVertex,
+        const RenderState& state = RenderState())
+    {
+        if (!prepare(shader, mesh, state)) { return; }
+        ASSERT(mesh.validIndices());
+        const GLenum glmode = static_cast<GLenum>(state.drawMode);
+
+        GL_CHECK(glDrawElementsBaseVertex(glmode, indiceCount, GL_UNSIGNED_INT,
+                                          (void*)(size_t(firstIndex) * sizeof(uint32_t)), baseVertex));
+
+        ++drawCalls;
+
+        mesh.unbind();
+    }
+
+    // Draws a range returned by GPUVertexData::mapStream()
+    template <typename T>
+    static void drawStream(
+        Shader&                                 shader,
+        GPUVertexData&                          mesh,
+        const GPUVertexData::StreamRange<T>&    range,
+        const RenderState&                      state = RenderState())
+    {
+        drawRange(shader, mesh, range.indiceCount, range.firstIndex, range.baseVertex, state);
+    }
+
     static void drawIndices(Shader& shader, Span<uint32_t> indices, const RenderState& state = RenderState())
     {
         if (!prepare(shader, state)) { return; }
@@ -170,6 +228,26 @@ public:
         return { fbw, fbh };
     }
 
+    /**
+     * How many frames the CPU can get ahead of the GPU with streamed geometry.
+     * 1 orphans the streaming buffers when they're full and leaves the syncing to the driver.
+     * 2 or more gives every frame its own region of the buffers, guarded by a fence,
+     * so the next frame is written while the GPU still draws the previous ones.
+     * Frames end on Window::swap().
+     */
+    static inline void setFramesInFlight(uint32_t frames)
+    {
+        ASSERT(frames > 0 && frames <= GPUVertexData::maxStreamFrames);
+        framesInFlight = frames;
+    }
+
+    [[nodiscard]] [[maybe_unused]]
+    static inline uint32_t getFramesInFlight() { return framesInFlight; }
+
+    // Counts up on every Window::swap()
+    [[nodiscard]] [[maybe_unused]]
+    static inline uint64_t getFrameIndex() { return Window::swapCount; }
+
     [[nodiscard]] [[maybe_unused]]
     static inline size_t getDrawCount() { return drawCalls; }
 
@@ -8,6 +8,8 @@
 #include <TLib/Media/View.hpp>
 #include <TLib/Media/Frustum.hpp>
 #include <TLib/Media/Resource/Font.hpp>
+#include <TLib/Media/Resource/TextureAutoAtlas.hpp>
+#include <TLib/Media/Tessellator2D.hpp>
 #include <TLib/EASTL.hpp>
 #include <TLib/Containers/Vector.hpp>
 #include <TLib/Containers/UnorderedMap.hpp>
@@ -16,6 +18,9 @@
 #include <TLib/Media/RenderTarget.hpp>
 #include <TLib/Embed/Embed.hpp>
 #include <TLib/Media/Platform/Input.hpp>
+#include <TLib/SIMD.hpp>
+#include <TLib/Threading.hpp>
+#include <TLib/Timer.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <span>
 
@@ -30,6 +35,92 @@ struct Renderer2DOrigin
     Vector2f pos = { FLT_MAX, FLT_MAX };
 };
 
+// How Renderer2D joins the segments of a line strip or loop, see Renderer2D::setLineJoin()
+enum class Renderer2DLineJoin
+{
+    None,  // Segments are drawn as separate quads, leaving a notch on the outside of turns
+    Miter, // Pointed corners, sharp turns past the miter limit fall back to Bevel
+    Bevel, // Corners cut flat
+    Round
+};
+
+// One sprite for Renderer2D::drawTextures()
+struct SpriteInstance
+{
+    Vector2f   pos;                               // Center of the sprite
+    Vector2f   size;                              // World size, negative to flip
+    Rectf      srcrect;                           // In texels
+    float      rotation = 0.f;                    // Radians, around pos
+    ColorRGBAf color    = { 1.f, 1.f, 1.f, 1.f };
+};
+
+// One panel for Renderer2D::drawNinePatches()
+struct NinePatch
+{
+    Rectf      srcRect;                           // In texels
+    Rectf      dstRect;
+    float      left     = 0.f;                    // Border sizes, in texels. They're drawn 1:1 in world units
+    float      right    = 0.f;
+    float      top      = 0.f;
+    float      bottom   = 0.f;
+    ColorRGBAf color    = { 1.f, 1.f, 1.f, 1.f };
+};
+
+// Why Renderer2D had to start a new batch (and draw call), see Renderer2DStats
+enum class Renderer2DBatchBreak
+{
+    Texture,    // Texture slots ran out, or the shader can only sample one texture
+    Shader,
+    DrawMode,
+    Instancing, // Switched between instanced sprites and the vertex path
+    WrappedUVs, // Switched between sprites with uvs past their texture and the packed vertex path
+    Count
+};
+
+// The draw command that started a new batch
+struct Renderer2DBatchBreakInfo
+{
+    Renderer2DBatchBreak reason;
+    int                  layer;
+    const Texture*       texture;
+    const Shader*        shader;
+    GLDrawMode           drawMode;
+};
+
+// What Renderer2D did during one frame, see Renderer2D::getStats()
+struct Renderer2DStats
+{
+    uint32_t commands      = 0; // Draw commands that made it past culling
+    uint32_t flushes       = 0; // render() calls that had something to draw
+    uint32_t batches       = 0; // Draw calls
+    uint32_t vertices      = 0; // Uploaded to the streaming buffers
+    uint32_t indices       = 0;
+    uint32_t instances     = 0;
+    uint32_t atlased       = 0; // Commands drawn from an auto atlas instead of their texture, see setAutoAtlasEnabled()
+    uint32_t cachedText    = 0; // drawText() calls on the main thread copied from the glyph run cache, see setGlyphRunCacheEnabled()
+    uint32_t cachedShapes  = 0; // drawFilledPolygon() calls on the main thread copied from the polygon cache, see setPolygonCacheEnabled()
+    size_t   bytesUploaded = 0;
+    double   sortMs        = 0; // Time spent sorting the draw commands
+    double   buildMs       = 0; // Time spent laying out batches and copying them into the buffers
+
+    // Batches started for each reason. The first batch of a flush isn't a break.
+    Array<uint32_t, size_t(Renderer2DBatchBreak::Count)> breaks = {};
+
+    // Every break of the frame, in draw order
+    Vector<Renderer2DBatchBreakInfo> breakLog;
+
+    [[nodiscard]] uint32_t breakCount(Renderer2DBatchBreak reason) const
+    { return breaks[size_t(reason)]; }
+
+    void clear()
+    {
+        Vector<Renderer2DBatchBreakInfo> log = eastl::move(breakLog);
+        *this = Renderer2DStats();
+        breakLog = eastl::move(log);
+        breakLog.clear(); // Keeps its capacity
+    }
+};
+
 struct Renderer2D
 {
 #pragma region Public
@@ -42,18 +133,25 @@ public:
     static bool created()      { return inited; }
     static void create()       { init();        }
 
+    // Draw calls made on a worker thread, see beginCommandList()
+    struct CommandList;
+
     /*
     @param sort If false, Ignore layer parameter and draw everthing back to front
     @param ignoreCamera If true, will render using the default camera. Useful for drawing UI and FBOs
+                        Draw calls are culled against the view that was set when they were made,
+                        so pass cull = false for screen space draws made while another view is set
     */
     static void render(bool sort = false, bool ignoreCamera = false)
     {
+        ASSERT(!recording); // Can't render while a StaticBatch2D is recording
+
         if (ignoreCamera)
         {
             auto oldView = currentView;
-            Renderer2D::resetView();
+            applyView(getDefaultCamera());
             flush(sort);
-            currentView = oldView;
+            applyView(oldView);
         }
         else
         {
@@ -61,9 +159,17 @@ public:
         }
     }
 
+    /*
+    Draw calls are culled against the view that's set when they're made, but drawn with the one that's set
+    when render() is called. Set the view before the frame's draw calls, or render() the ones made with the old view first.
+    Asserts when draw calls queued on this thread were culled against other bounds.
+    */
     static void setView(const View& view)
     {
-        currentView = view;
+        ASSERTMSG(!cullingEnabled || drawCmds.empty() || view.getBounds() == cullBounds,
+                  "Renderer2D::setView() with draw calls queued, they were culled against the old view. "
+                  "Set the view before drawing, or call render() first");
+        applyView(view);
     }
 
     [[nodiscard]]
@@ -94,6 +200,164 @@ public:
         return localToWorldPoint(pos, Renderer2D::getView(), Renderer::getFramebufferSize());
     }
 
+    /*
+    When enabled, draw calls outside of the current view are thrown away before they're batched.
+    Culling uses the view that's set when the draw call is made.
+    Every draw call also takes a cull parameter, pass false to skip culling for that call
+    (for example when drawing into a render target that uses a different view).
+    */
+    static void setCullingEnabled(bool enabled)
+    { cullingEnabled = enabled; }
+
+    [[nodiscard]]
+    static bool isCullingEnabled()
+    { return cullingEnabled; }
+
+    /*
+    When enabled, sprites and text drawn with the default shaders are sent to the GPU as one
+    compact instance each (see SpriteInstanceData) and expanded into quads by 2d_instanced.vert,
+    instead of 4 vertices and 6 indices built on the CPU.
+    Sprites drawn with a custom shader always use the vertex path, since their vertex stage expects 2d.vert's inputs.
+    */
+    static void setInstancingEnabled(bool enabled)
+    { instancingEnabled = enabled; }
+
+    [[nodiscard]]
+    static bool isInstancingEnabled()
+    { return instancingEnabled; }
+
+    /*
+    Lines and rect outlines are built out of triangles, so they batch with sprites.
+    Width is in world units, joins apply to line strips and loops. Both are read when the draw call is made.
+    Segments and joins overlap a little, which shows with transparent colors.
+    */
+    static void setLineWidth(float width)
+    { lineWidth = std::max(width, 0.f); }
+
+    [[nodiscard]]
+    static float getLineWidth()
+    { return lineWidth; }
+
+    static void setLineJoin(Renderer2DLineJoin join)
+    { lineJoin = join; }
+
+    [[nodiscard]]
+    static Renderer2DLineJoin getLineJoin()
+    { return lineJoin; }
+
+    /*
+    When enabled, small textures drawn with the default shader, like with drawTexture(), are copied into shared atlases
+    as they get used, and drawn from there so they batch together. Which textures share an atlas follows which ones
+    are drawn in the same frames. Atlases of textures that stopped being drawn are rebuilt, and mostly empty ones merged.
+    Textures are read back from the GPU the first time they're drawn, and again whenever setData() or setSubData() changes them.
+    Shapes, text, custom shaders and render targets are left alone. Disabling it frees the atlases.
+    */
+    static void setAutoAtlasEnabled(bool enabled, const TextureAutoAtlasSettings& settings = {})
+    {
+        if (enabled) { autoAtlas.create(settings); }
+        else         { autoAtlas.reset();          }
+    }
+
+    [[nodiscard]]
+    static bool isAutoAtlasEnabled()
+    { return autoAtlas.created(); }
+
+    [[nodiscard]]
+    static size_t getAutoAtlasCount()
+    { return autoAtlas.atlasCount(); }
+
+    /*
+    When enabled, drawText() lays each string out once and keeps the quads, so drawing the same string with the same
+    font and scale again is a copy into the batch instead of decoding and looking up every glyph.
+    Each string is one draw command either way. Strings not drawn for a while are dropped, and every thread keeps its own cache.
+    Disabling it clears the calling thread's cache now, and every other thread's the next time it draws text.
+    */
+    static void setGlyphRunCacheEnabled(bool enabled)
+    {
+        glyphRunCacheEnabled.store(enabled, std::memory_order_relaxed);
+        if (!enabled) { ++glyphRunClears; }
+        clearStaleGlyphRuns(glyphRuns);
+    }
+
+    [[nodiscard]]
+    static bool isGlyphRunCacheEnabled()
+    { return glyphRunCacheEnabled.load(std::memory_order_relaxed); }
+
+    /*
+    When enabled, drawFilledPolygon() tessellates each shape once and keeps the triangles, so drawing the same points
+    again, anywhere and at any rotation, only copies them into the batch.
+    Shapes not drawn for a while are dropped, and every thread keeps its own cache.
+    Disabling it clears the calling thread's cache now, and every other thread's the next time it draws a filled polygon.
+    */
+    static void setPolygonCacheEnabled(bool enabled)
+    {
+        polygonCacheEnabled.store(enabled, std::memory_order_relaxed);
+        if (!enabled) { ++polygonMeshClears; }
+        clearStalePolygonMeshes(polygonMeshes);
+    }
+
+    [[nodiscard]]
+    static bool isPolygonCacheEnabled()
+    { return polygonCacheEnabled.load(std::memory_order_relaxed); }
+
+    // Stats of the last frame that ended with Window::swap()
+    [[nodiscard]]
+    static const Renderer2DStats& getStats()
+    { return lastStats; }
+
+    /*
+    When enabled, render() copies big frames into the vertex buffers from several threads.
+    The threads are created the first time a frame is big enough. GL calls stay on the calling thread.
+    */
+    static void setParallelBuildEnabled(bool enabled)
+    { parallelBuildEnabled = enabled; }
+
+    [[nodiscard]]
+    static bool isParallelBuildEnabled()
+    { return parallelBuildEnabled; }
+
+    /*
+    Draw calls can be made from several threads at once by giving each thread its own command list:
+
+        Renderer2D::CommandList lists[workerCount];
+
+        // On worker i
+        Renderer2D::beginCommandList(lists[i]);
+        Renderer2D::drawTexture(...); // Any Renderer2D draw calls
+        Renderer2D::endCommandList();
+
+        // On the main thread, once the workers are done
+        for (auto& list : lists) { Renderer2D::submitCommandList(list); }
+        Renderer2D::render(true);
+
+    render() merges the submitted lists after the draw calls made on the main thread, in submission order,
+    so submit them from one thread if the order of commands with equal state matters.
+    Lists keep their memory between frames and must stay alive until render().
+    The view, culling, instancing and line settings are shared, don't change them while workers are drawing.
+    So are fonts: text drawn on workers only uses the glyphs preloaded by Font::loadFromFile(), anything outside
+    that range is drawn as the fallback glyph, since loading glyphs needs the main thread, see Font::getGlyph().
+    Don't load fonts or change their settings while workers are drawing with them.
+    */
+    static void beginCommandList(CommandList& list)
+    {
+        ASSERT(!activeList); // Call endCommandList() first
+        activeList = &list;
+    }
+
+    static void endCommandList()
+    {
+        ASSERT(activeList); // Call beginCommandList() first
+        activeList = nullptr;
+    }
+
+    // Queues list for the next render(), can be called from any thread
+    static void submitCommandList(CommandList& list)
+    {
+        ASSERT(activeList != &list); // Call endCommandList() first
+        LockGuard lock(submittedMutex);
+        submittedLists.push_back(&list);
+    }
+
     // TODO: Make this a command, for now it is immediate.
     static void clearColor(const ColorRGBAf& color = { 0.1f, 0.1f, 0.1f, 1.f })
     { Renderer::clearColor(color); }
@@ -107,14 +371,15 @@ public:
                             const Renderer2DOrigin&   origin   = OriginCenter,
                             bool flipUvX                       = false,
                             bool flipUvY                       = false,
-                            Shader& shader                     = defaultShader)
+                            Shader& shader                     = defaultShader,
+                            bool cull                          = true)
     {
         sprite_batch(tex, Rectf(Vector2f{ 0.f,0.f }, Vector2f(tex.getSize())), dstrect,
             rotation,
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
     }
 
     // Rotation is in radians
@@ -126,7 +391,8 @@ public:
                             const Renderer2DOrigin&   origin   = OriginCenter,
                             bool flipUvX                       = false,
                             bool flipUvY                       = false,
-                            Shader& shader                     = defaultShader)
+                            Shader& shader                     = defaultShader,
+                            bool cull                          = true)
     {
         ASSERT(subTex.texture);
         sprite_batch(*subTex.texture, Rectf(subTex.rect), dstrect,
@@ -134,7 +400,7 @@ public:
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
     }
 
     // Rotation is in radians
@@ -147,7 +413,8 @@ public:
                             const Renderer2DOrigin&   origin   = OriginCenter,
                             bool flipUvX                       = false,
                             bool flipUvY                       = false,
-                            Shader& shader                     = defaultShader)
+                            Shader& shader                     = defaultShader,
+                            bool cull                          = true)
     {
         ASSERT(subTex.texture);
         Vector2f texSize     = Vector2f(subTex.rect.getSize()) * scale;
@@ -158,10 +425,12 @@ public:
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
     }
 
-    // Rotation is in radians
+    // Rotation is in radians.
+    // A srcrect reaching past the texture wraps by the texture's UV mode, the sprite is cut into a quad per tile for it.
+    // Past 64 tiles across it's clamped instead.
     static void drawTexture(        Texture&            tex,
                             const   Rectf&              srcrect,
                             const   Rectf&              dstrect,
@@ -171,14 +440,15 @@ public:
                             const   Renderer2DOrigin&   origin   = OriginCenter,
                             bool    flipUvX                      = false,
                             bool    flipUvY                      = false,
-                            Shader& shader                       = defaultShader)
+                            Shader& shader                       = defaultShader,
+                            bool    cull                         = true)
     {
         sprite_batch(tex, srcrect, dstrect,
             rotation,
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
     }
 
     // Rotation is in radians
@@ -192,7 +462,8 @@ public:
                             const   Renderer2DOrigin&   origin   = OriginCenter,
                             bool    flipUvX                      = false,
                             bool    flipUvY                      = false,
-                            Shader& shader                       = defaultShader)
+                            Shader& shader                       = defaultShader,
+                            bool    cull                         = true)
     {
         Vector2f texSize     = Vector2f(tex.getSize()) * scale;
         Vector2f halfTexSize = texSize/2.f;
@@ -202,7 +473,7 @@ public:
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
     }
 
     // Rotation is in radians
@@ -215,7 +486,8 @@ public:
                             const Renderer2DOrigin&   origin   = OriginCenter,
                             bool flipUvX = false,
                             bool flipUvY = false,
-                            Shader& shader = defaultShader)
+                            Shader& shader = defaultShader,
+                            bool cull = true)
     {
         drawTexture(
             tex,
@@ -226,7 +498,22 @@ public:
             color,
             layer,
             origin,
-            flipUvX, flipUvY, shader);
+            flipUvX, flipUvY, shader, cull);
+    }
+
+    /*
+    Draws many sprites using the same texture at once.
+    Much faster than calling drawTexture() for each of them: the vertices of 4 sprites
+    are built at a time with SIMD, and all of them share one draw command.
+    Sprites whose srcrect reaches past the texture are drawn like drawTexture() does, in commands of their own after the rest.
+    */
+    static void drawTextures(      Texture&                        tex,
+                             const std::span<const SpriteInstance> sprites,
+                             const int                             layer  = DefaultSpriteLayer,
+                             Shader&                               shader = defaultShader,
+                             const bool                            cull   = true)
+    {
+        sprites_batch(tex, sprites, layer, shader, cull);
     }
 
     static void drawRenderTarget(RenderTarget&           target,
@@ -238,9 +525,10 @@ public:
                                  const Renderer2DOrigin& origin   = OriginCenter,
                                  bool                    flipUvX  = false,
                                  bool                    flipUvY  = false,
-                                 Shader&                 shader   = defaultShader)
+                                 Shader&                 shader   = defaultShader,
+                                 bool                    cull     = true)
     {
-        drawTexture(target.texture, srcrect, dstrect, rotation, color, layer, origin, flipUvX, flipUvY, shader);
+        drawTexture(target.texture, srcrect, dstrect, rotation, color, layer, origin, flipUvX, flipUvY, shader, cull);
     }
 
     static void drawRenderTarget(RenderTarget&          target,
@@ -251,15 +539,18 @@ public:
                                 const Renderer2DOrigin& origin   = OriginCenter,
                                 bool                    flipUvX  = false,
                                 bool                    flipUvY  = false,
-                                Shader&                 shader   = defaultShader)
+                                Shader&                 shader   = defaultShader,
+                                bool                    cull     = true)
     {
-        drawTexture(target.texture, dstrect, rotation, color, layer, origin, flipUvX, flipUvY, shader);
+        drawTexture(target.texture, dstrect, rotation, color, layer, origin, flipUvX, flipUvY, shader, cull);
     }
 
     static void drawFinalRenderTarget(RenderTarget& rt)
     {
         Renderer2D::setView(rt.view);
-        Renderer2D::drawRenderTarget(rt, Rectf(0, 0, Vector2f(rt.texture.getSize())));
+        // Drawn in screen space by render(..., true), so rt.view's bounds don't apply
+        Renderer2D::drawRenderTarget(rt, Rectf(0, 0, Vector2f(rt.texture.getSize())),
+                                     0.f, ColorRGBAf::white(), DefaultSpriteLayer, OriginCenter, false, false, defaultShader, false);
     }
 
     static void bindRenderTarget(RenderTarget& rt)
@@ -273,80 +564,99 @@ public:
     Draws an image using 9(slice/grid/patch) scaling
     https://en.wikipedia.org/wiki/9-slice_scaling
 
-    If your (dstRect.width < left + right || dstRect.height < top + bottom)
-    your image will probably look weird
+    The panel is one 16 vertex mesh. If dstRect is smaller than the borders,
+    they're shrunk to fit.
     */
     static void drawNinePatchTex(
             Texture& tex,
         const Rectf& srcRect,
         const Rectf& dstRect,
-        float left, float right, float top, float bottom)
-    {
-        // What a process zzzzzzzzz
-        const Vector2f& totalSize = Vector2f(srcRect.getSize());
-
-        Vector2f centerSize = totalSize;
-        centerSize.x -= left + right;
-        centerSize.y -= top + bottom;
-        Vector2f centerPos = srcRect.getPos() + Vector2f{left, top};
-        Rectf centerSrc ={centerPos, centerSize};
-
-        Rectf mtSrc ={srcRect.getPos() + Vector2f(left,                0), centerSize.x, top};
-        Rectf mlSrc ={srcRect.getPos() + Vector2f(0,                   top), left,         centerSize.y};
-        Rectf mrSrc ={srcRect.getPos() + Vector2f(totalSize.x - right, top), right,        centerSize.y};
-        Rectf mbSrc ={srcRect.getPos() + Vector2f(left,                totalSize.y - bottom), centerSize.x, bottom};
-        Rectf tlSrc ={srcRect.getPos() + Vector2f(0,                   0), left,         right};
-        Rectf trSrc ={srcRect.getPos() + Vector2f(totalSize.x - right, 0), right,        top};
-        Rectf blSrc ={srcRect.getPos() + Vector2f(0,                   totalSize.y - bottom), left,         bottom};
-        Rectf brSrc ={srcRect.getPos() + Vector2f(totalSize.x - right, totalSize.y - bottom), right,        bottom};
-
-        Rectf centerDst ={dstRect.x + left, dstRect.y + top, dstRect.width - right - left, dstRect.height - bottom - top};
-
-        Rectf mtDst ={dstRect.x + left,           dstRect.y,                    centerDst.width, top};
-        Rectf mlDst ={dstRect.x,                  dstRect.y + top,              left,            centerDst.height};
-        Rectf mrDst ={dstRect.getRight() - right, dstRect.y + top,              right,           centerDst.height};
-        Rectf mbDst ={dstRect.x + left,           dstRect.getBottom() - bottom, centerDst.width, bottom};
-
-        Rectf tlDst ={dstRect.getPos(),                           tlSrc.getSize()};
-        Rectf trDst ={dstRect.getRight() - right,                 dstRect.y,                    trSrc.getSize()};
-        Rectf blDst ={dstRect.x,                                  dstRect.getBottom() - bottom, blSrc.getSize()};
-        Rectf brDst ={dstRect.getRightBottom() - brSrc.getSize(), brSrc.getSize()};
-
-        drawTexture(tex, mtSrc, mtDst); // Draw sides
-        drawTexture(tex, mlSrc, mlDst);
-        drawTexture(tex, mrSrc, mrDst);
-        drawTexture(tex, mbSrc, mbDst);
-        drawTexture(tex, tlSrc, tlDst); // Then corners
-        drawTexture(tex, trSrc, trDst);
-        drawTexture(tex, blSrc, blDst);
-        drawTexture(tex, brSrc, brDst);
-        drawTexture(tex, centerSrc, centerDst); // Then center
+        float left, float right, float top, float bottom,
+        bool  cull = true)
+    {
+        const NinePatch panel = { srcRect, dstRect, left, right, top, bottom };
+        ninepatch_batch(tex, { &panel, 1 }, DefaultSpriteLayer, cull);
     }
 
     static void drawNinePatchTex(
             Texture& tex,
         const Rectf& dstRect,
-        float left, float right, float top, float bottom)
+        float left, float right, float top, float bottom,
+        bool  cull = true)
+    {
+        drawNinePatchTex(tex, Rectf(0.f, 0.f, Vector2f(tex.getSize())), dstRect, left, right, top, bottom, cull);
+    }
+
+    // Many nine patch panels sharing a texture, queued as a single draw command
+    static void drawNinePatches(      Texture&                   tex,
+                                const std::span<const NinePatch> panels,
+                                const int                        layer = DefaultSpriteLayer,
+                                const bool                       cull  = true)
     {
-        drawNinePatchTex(tex, Rectf(0.f, 0.f, Vector2f(tex.getSize())), dstRect, left, right, top, bottom);
+        ninepatch_batch(tex, panels, layer, cull);
     }
 
-    // loop: will draw a line between first and last point
+    // Line modes (LineStrip, LineLoop, Lines, Points) use the line width and join,
+    // triangle modes (TriangleFan, TriangleStrip, Triangles) are filled
     static void drawLines(const std::span<const Vector2f>& points,
                           const ColorRGBAf&                color    = ColorRGBAf::white(),
                           GLDrawMode                       drawMode = GLDrawMode::LineStrip,
-                          const int                        layer    = DefaultPrimitiveLayer)
+                          const int                        layer    = DefaultPrimitiveLayer,
+                          const bool                       cull     = true)
+    {
+        prim_batch(points, color, drawMode, layer, cull);
+    }
+
+    // Polygon, outlined with a line loop or filled. Convex ones are filled with a triangle fan, concave ones
+    // are tessellated on every call. drawFilledPolygon() keeps the triangles of shapes drawn again.
+    static void drawPolygon(const std::span<const Vector2f>& points,
+                            const bool                       filled = false,
+                            const ColorRGBAf&                color  = ColorRGBAf::white(),
+                            const int                        layer  = DefaultPrimitiveLayer,
+                            const bool                       cull   = true)
+    {
+        if (!filled)
+        {
+            prim_batch(points, color, GLDrawMode::LineLoop, layer, cull);
+            return;
+        }
+
+        if (isConvex(points))
+        {
+            prim_batch(points, color, GLDrawMode::TriangleFan, layer, cull);
+            return;
+        }
+
+        PolygonMesh& mesh = polygonMeshes.scratch;
+        buildPolygonMesh(mesh, points, {});
+        polygon_batch(mesh, Vector2f(0.f, 0.f), 0.f, color, layer, cull);
+    }
+
+    /*
+    Filled polygon with holes, concave or not. points are relative to pos, the outline and then every hole,
+    holeStarts is where each hole starts in points. Rotated by rotation radians around pos.
+    The triangles are cached by the points, see setPolygonCacheEnabled(), so keep the points of a shape the same
+    from frame to frame and move it with pos and rotation.
+    */
+    static void drawFilledPolygon(const std::span<const Vector2f>& points,
+                                  const std::span<const uint32_t>  holeStarts,
+                                  const Vector2f&                  pos,
+                                  const float                      rotation = 0.f,
+                                  const ColorRGBAf&                color    = ColorRGBAf::white(),
+                                  const int                        layer    = DefaultPrimitiveLayer,
+                                  const bool                       cull     = true)
     {
-        prim_batch(points, color, drawMode, layer);
+        polygon_batch(findPolygonMesh(points, holeStarts), pos, rotation, color, layer, cull);
     }
 
     static void drawLine(const Vector2f&   start,
                          const Vector2f&   end,
                          const ColorRGBAf& color = ColorRGBAf::white(),
-                         const int         layer = DefaultPrimitiveLayer)
+                         const int         layer = DefaultPrimitiveLayer,
+                         const bool        cull  = true)
     {
         Vector2f line[2] = { start, end };
-        prim_batch(line, color, GLDrawMode::LineStrip, layer);
+        prim_batch(line, color, GLDrawMode::LineStrip, layer, cull);
     }
 
     static void drawRect(float                   x,
@@ -357,7 +667,8 @@ public:
                          bool                    filled = false,
                          const ColorRGBAf&       color  = ColorRGBAf::white(),
                          const Renderer2DOrigin& origin = OriginCenter,
-                         const int               layer  = DefaultPrimitiveLayer)
+                         const int               layer  = DefaultPrimitiveLayer,
+                         const bool              cull   = true)
     {
         Vector2f verts[4] = {
             Vector2f(x,     y    ),
@@ -389,7 +700,7 @@ public:
             }
         }
 
-        prim_batch(verts, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop, layer);
+        prim_batch(verts, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop, layer, cull);
     }
 
     static void drawRect(const Rectf&            rect,
@@ -397,9 +708,10 @@ public:
                          bool                    filled = false,
                          const ColorRGBAf&       color  = ColorRGBAf::white(),
                          const Renderer2DOrigin& origin = OriginCenter,
-                         const int               layer  = DefaultPrimitiveLayer)
+                         const int               layer  = DefaultPrimitiveLayer,
+                         const bool              cull   = true)
     {
-        drawRect(rect.x, rect.y, rect.width, rect.height, rot, filled, color, origin, layer);
+        drawRect(rect.x, rect.y, rect.width, rect.height, rot, filled, color, origin, layer, cull);
     }
 
     static void drawGrid(const Vector2f&   offset,
@@ -430,44 +742,87 @@ public:
         }
     }
 
-    // TODO: Remove heap alloc
+    /*
+    Circles, rings, rounded rects and capsules are one quad each, shaded by their signed distance in 2d_shape.frag.
+    They're antialiased at any size and batch with each other. Outlines are centered on the edge and are
+    getLineWidth() wide, like the ones made of lines.
+    StaticBatch2D recordings can't hold them, so there they're built out of recordedCircleSegments triangles like lines are.
+    */
+    static void drawCircle(const Vector2f&   pos,
+                           const float       rad,
+                           const bool        filled = false,
+                           const ColorRGBAf& color  = ColorRGBAf::white(),
+                           const int         layer  = DefaultPrimitiveLayer,
+                           const bool        cull   = true)
+    { circle_batch(pos, rad, filled, color, recordedCircleSegments, layer, cull); }
+
+    // segmentCount only sets how many triangles a circle gets in a StaticBatch2D recording.
+    // layer has no default so five arguments pick the overload above, a fifth argument that was segmentCount is the layer now.
+    [[deprecated("segmentCount is ignored outside StaticBatch2D recordings, use the overload without it")]]
     static void drawCircle(const Vector2f&   pos,
                            const float       rad,
-                           const bool        filled       = false,
-                           const ColorRGBAf& color        = ColorRGBAf::white(),
-                           const int         segmentCount = 16,
-                           const int         layer        = DefaultPrimitiveLayer)
+                           const bool        filled,
+                           const ColorRGBAf& color,
+                           const int         segmentCount,
+                           const int         layer,
+                           const bool        cull = true)
+    { circle_batch(pos, rad, filled, color, segmentCount, layer, cull); }
+
+    // A circle outline thickness wide, inside radius
+    static void drawRing(const Vector2f&   pos,
+                         const float       radius,
+                         const float       thickness,
+                         const ColorRGBAf& color = ColorRGBAf::white(),
+                         const int         layer = DefaultPrimitiveLayer,
+                         const bool        cull  = true)
     {
-        const float theta = 3.1415926f * 2.f / static_cast<float>(segmentCount);
-        const float tangetial_factor = tanf(theta);
-        const float radial_factor = cosf(theta);
-
-        float x = rad;
-        float y = 0;
-
-        Vector<Vector2f> points;
-        points.reserve(segmentCount);
+        shape_batch(pos, Vector2f(radius, radius), radius, thickness, 0.f, color, layer, cull);
+    }
 
-        for (int i = 0; i < segmentCount; i++)
+    static void drawRoundedRect(const Rectf&            rect,
+                                const float             cornerRadius,
+                                const float             rot    = 0.f,
+                                const bool              filled = false,
+                                const ColorRGBAf&       color  = ColorRGBAf::white(),
+                                const Renderer2DOrigin& origin = OriginCenter,
+                                const int               layer  = DefaultPrimitiveLayer,
+                                const bool              cull   = true)
+    {
+        Vector2f center = rect.getPos() + rect.getSize() / 2.f;
+        if (rot != 0.f && origin.pos.x != FLT_MAX)
         {
-            points.push_back(Vector2f{ x + pos.x, y + pos.y });
-
-            float tx = -y;
-            float ty = x;
-            x += tx * tangetial_factor;
-            y += ty * tangetial_factor;
-            x *= radial_factor;
-            y *= radial_factor;
+            const Vector2f realOrigin = origin.useWorldCoords ? origin.pos : rect.getPos() + origin.pos;
+            center -= realOrigin;
+            center.rotate(rot);
+            center += realOrigin;
         }
 
-        prim_batch(points, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop, layer);
+        const float grow = filled ? 0.f : lineWidth * 0.5f;
+        shape_batch(center, rect.getSize() / 2.f + Vector2f(grow, grow), cornerRadius > 0.f ? cornerRadius + grow : 0.f,
+                    filled ? 0.f : lineWidth, rot, color, layer, cull);
+    }
+
+    // A line with round caps, radius out from it
+    static void drawCapsule(const Vector2f&   start,
+                            const Vector2f&   end,
+                            const float       radius,
+                            const bool        filled = false,
+                            const ColorRGBAf& color  = ColorRGBAf::white(),
+                            const int         layer  = DefaultPrimitiveLayer,
+                            const bool        cull   = true)
+    {
+        const Vector2f dir   = end - start;
+        const float    outer = filled ? radius : radius + lineWidth * 0.5f;
+        shape_batch((start + end) / 2.f, Vector2f(dir.length() / 2.f + outer, outer), outer,
+                    filled ? 0.f : lineWidth, std::atan2(dir.y, dir.x), color, layer, cull);
     }
 
     static void drawTriangle(const Vector2f&   pos,  // Center of triangle
                              const Vector2f&   size, // Width and height
                              float             rot = 0.f,
                              bool              filled = false,
-                             const ColorRGBAf& color = ColorRGBAf::white())
+                             const ColorRGBAf& color = ColorRGBAf::white(),
+                             const bool        cull  = true)
     {
         const Vector2f halfSize = size / 2.f;
         Array<Vector2f, 3> points;
@@ -483,17 +838,18 @@ public:
         points[0] += pos;
         points[1] += pos;
         points[2] += pos;
-        Renderer2D::drawLines(points, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop);
+        Renderer2D::drawLines(points, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop, DefaultPrimitiveLayer, cull);
     }
 
-    static void drawText(const String&     text,
+    static void drawText(std::string_view  text,
                          Font&             font,
                          const Vector2f&   pos,
                          const ColorRGBAf& color = ColorRGBAf::white(),
                          const float       scale = 1.f,
-                         const int         layer = DefaultTextLayer)
+                         const int         layer = DefaultTextLayer,
+                         const bool        cull  = true)
     {
-        text_batch(text, font, pos, layer, color, scale);
+        text_batch(text, font, pos, layer, color, scale, cull);
     }
 
     static void drawChar(wchar_t                 ch,
@@ -505,10 +861,12 @@ public:
                          const Renderer2DOrigin& origin   = OriginCenter,
                          const bool              flipuvx  = false,
                          const bool              flipuvy  = false,
-                         Shader&                 shader   = textShader)
+                         Shader&                 shader   = textShader,
+                         const bool              cull     = true)
     {
-        sprite_batch(font.getAtlas(), font.getCharTex(ch).rect, dstrect,
-            rotation, color, layer, origin, flipuvx, flipuvy, shader);
+        const SubTexture glyph = font.getCharTex(ch);
+        sprite_batch(*glyph.texture, glyph.rect, dstrect,
+            rotation, color, layer, origin, flipuvx, flipuvy, shader, cull);
     }
 
     static void drawChar(wchar_t             ch,
@@ -520,24 +878,28 @@ public:
                      const Renderer2DOrigin& origin   = OriginCenter,
                      const bool              flipuvx  = false,
                      const bool              flipuvy  = false,
-                     Shader&                 shader   = textShader)
+                     Shader&                 shader   = textShader,
+                     const bool              cull     = true)
     {
-        Rectf rect    = font.getCharTex(ch).rect;
+        const SubTexture glyph = font.getCharTex(ch);
+        Rectf rect    = glyph.rect;
         Rectf dstRect = Rectf(pos - (rect.getSize()/2.f), rect.getSize());
-        sprite_batch(font.getAtlas(), rect, dstRect,
-            rotation, color, layer, origin, flipuvx, flipuvy, shader);
+        sprite_batch(*glyph.texture, rect, dstRect,
+            rotation, color, layer, origin, flipuvx, flipuvy, shader, cull);
     }
 
     static inline void setSDFTextWidth(const float width)
     {
         sdfTextWidth = width;
-        textShader.setFloat("width", width);
+        textShader         .setFloat("width", width);
+        instanceTextShader .setFloat("width", width);
     }
 
     static inline void setSDFTextEdge(const float edge)
     {
         sdfTextEdge = edge;
-        textShader.setFloat("edge", edge);
+        textShader         .setFloat("edge", edge);
+        instanceTextShader .setFloat("edge", edge);
     }
 
     static inline float getSDFTextWidth()
@@ -552,6 +914,18 @@ public:
                         rect.y + rect.height / 2);
     }
 
+    // True if the rect overlaps the area of the world visible through the current view
+    // Rects with a negative size (flipped sprites) are handled too
+    static inline bool isVisible(const Rectf& rect)
+    {
+        const float left   = std::min(rect.x, rect.getRight());
+        const float right  = std::max(rect.x, rect.getRight());
+        const float top    = std::min(rect.y, rect.getBottom());
+        const float bottom = std::max(rect.y, rect.getBottom());
+        return left <= cullBounds.getRight()  && right  >= cullBounds.x &&
+               top  <= cullBounds.getBottom() && bottom >= cullBounds.y;
+    }
+
     static Pair<Vector2f, Vector2f> getTextureUVs(const Texture& tex, const Rectf& srcRect)
     {
         const Vector2f texSize(tex.getSize());
@@ -566,6 +940,9 @@ public:
 
 #pragma region Impl
 private:
+    friend struct StaticBatch2D;
+    friend struct ParticleSystem2D;
+
     using IndiceCont = Vector<uint32_t>;
 
     struct DrawCmd
@@ -574,66 +951,356 @@ private:
         GLDrawMode drawMode;
         Texture*   texture = &whiteTex;
         Shader*    shader  = &defaultShader;
-        uint32_t   posIndex, posSize; // Index and size for posAndCoords
+        uint32_t   posIndex, posSize; // Index and size for vertices, or for instances if instanced
         uint32_t   indIndex, indSize; // Index and size for indices
-        ColorRGBAf color;
-
-        bool operator<(const DrawCmd& other)
-        {
-            if (layer       < other.layer) return true;
-            if (other.layer < layer      ) return false;
-
-            if (shader       < other.shader) return true;
-            if (other.shader < shader)       return false;
+        uint64_t   key       = 0;     // See makeSortKey()
+        bool       instanced = false; // See setInstancingEnabled()
+        bool       wrapped   = false; // Vertices are WrapVerts, see wrapped_sprite_batch()
+        uint8_t    texSlot   = 0;     // Index into batchTextures, assigned in flush()
+    };
 
-            if (texture       < other.texture) return true;
-            if (other.texture < texture)       return false;
+    // 20 bytes, see 2d.vert
+    struct PrimVert
+    {
+        Vector2f   pos;
+        uint16_t   u, v;     // Normalized
+        ColorRGBAi color;
+        uint32_t   texIndex; // Texture slot of the batch
+    };
+    static_assert(sizeof(PrimVert) == 20);
 
-            if (static_cast<int>(drawMode)       < static_cast<int>(other.drawMode)) return true;
-            if (static_cast<int>(other.drawMode) < static_cast<int>(drawMode)      ) return false;
+    // PrimVert with float uvs, for sprites whose srcrect reaches past the texture so its UV mode can wrap them.
+    // 24 bytes, drawn from wrapMesh with the same shaders.
+    struct WrapVert
+    {
+        Vector2f   pos;
+        Vector2f   uv;
+        ColorRGBAi color;
+        uint32_t   texIndex; // Texture slot of the batch
+    };
+    static_assert(sizeof(WrapVert) == 24);
 
-            return false;
-        }
+    // Everything 2d_instanced.vert needs to build one sprite.
+    // 44 bytes, vs 4 PrimVerts and 6 indices (104 bytes) on the vertex path.
+    struct SpriteInstanceData
+    {
+        Vector2f   pos;      // Top left of dstrect
+        Vector2f   size;
+        Vector2f   origin;   // Rotation origin, relative to pos
+        float      rotation; // Radians
+        uint16_t   uv[4];    // Top left and bottom right uvs, normalized
+        ColorRGBAi color;
+        float      texIndex; // Texture slot of the batch
     };
+    static_assert(sizeof(SpriteInstanceData) == 44);
 
-    struct PrimVert
+public:
+    struct CommandList
     {
-        glm::vec4  vert;
-        ColorRGBAf color;
+    private:
+        friend struct Renderer2D;
+        friend struct ParticleSystem2D;
+
+        Vector<DrawCmd>            drawCmds;
+        Vector<PrimVert>           vertices;
+        IndiceCont                 indices;
+        Vector<SpriteInstanceData> instances;
+        Vector<WrapVert>           wrapVertices;
+        Vector<Vector2f>           points;    // Scratch space for primitives that build their points, like drawCircle()
+
+        void clear()
+        {
+            drawCmds    .clear();
+            vertices    .clear();
+            indices     .clear();
+            instances   .clear();
+            wrapVertices.clear();
+        }
     };
 
+private:
+
     static inline IndiceCont sprite_indices ={ 0, 2, 1, 1, 2, 3 };
+
+    // 3x3 quads over a 4x4 grid of vertices, in rows from the top left
+    static inline IndiceCont ninepatch_indices = []()
+    {
+        IndiceCont inds;
+        for (uint32_t y = 0; y < 3; y++)
+        {
+            for (uint32_t x = 0; x < 3; x++)
+            {
+                const uint32_t tl = y * 4 + x;
+                for (const uint32_t i : { 0u, 4u, 1u, 1u, 4u, 5u })
+                { inds.push_back(tl + i); }
+            }
+        }
+        return inds;
+    }();
     static inline Texture    whiteTex;
     static inline GLubyte    whiteTexData[1][1][4] =
                              { { {255, 255, 255, 255} } };
 
     static constexpr GLuint   restartIndex = std::numeric_limits<GLuint>::max();
 
+    // Initial size of the streaming ring, it grows if a single batch doesn't fit
+    static constexpr uint32_t streamVertexCapacity = 1024 * 64;
+    static constexpr uint32_t streamIndiceCapacity = 1024 * 96;
+
+    static constexpr uint32_t streamInstanceCapacity = 1024 * 16;
+
+    static constexpr uint32_t streamWrapVertexCapacity = 1024 * 4;
+    static constexpr uint32_t streamWrapIndiceCapacity = 1024 * 6;
+
     static inline GPUVertexData mesh;
+    static inline GPUVertexData instanceMesh;
+    static inline GPUVertexData wrapMesh; // See WrapVert
+    static inline uint64_t      streamFrameIndex = UINT64_MAX; // Renderer::getFrameIndex() of the last flush
+
+    // See getStats(), stats is the frame being drawn
+    static inline Renderer2DStats stats;
+    static inline Renderer2DStats lastStats;
+    static inline uint64_t        statsFrameIndex = UINT64_MAX;
     static inline Shader        defaultShader;
     static inline Shader        textShader;
+    static inline Shader        instanceShader;     // 2d_instanced.vert + 2d.frag
+    static inline Shader        instanceTextShader; // 2d_instanced.vert + sdf_text.frag
+    static inline Shader        shapeShader;        // 2d_shape.vert + 2d_shape.frag, see shape_batch()
+    static inline bool          instancingEnabled = false;
+
+    // Batches built with the default shaders can use several textures, see the images sampler array in 2d.frag.
+    // Textures used by the batch being built go here, DrawCmd::texSlot indexes into it.
+    static constexpr int                              maxTextureSlots = 16;
+    static inline    Array<Texture*, maxTextureSlots> batchTextures;
+    static inline    int                              batchTextureCount = 0;
+    static inline    int                              textureSlotCount  = 1; // Limited by Renderer::getMaxTextureUnits()
     static inline View          currentView;
     static inline bool          inited = false;
 
     static inline float sdfTextWidth;
     static inline float sdfTextEdge;
 
-    // TODO: actually use the frustum
-    // need to calculate AABB of the sprites rect to check collision
-    // checking for primitives isn't necessary
-    static inline Frustum frustum;
+    // See setLineWidth()
+    static inline float              lineWidth = 1.f;
+    static inline Renderer2DLineJoin lineJoin  = Renderer2DLineJoin::Miter;
+
+    // Same meaning as SVG's stroke-miterlimit: miter length / line width
+    static constexpr float miterLimit = 4.f;
+
+    // Round joins get one triangle per this many radians
+    static constexpr float roundJoinStep = 3.1415926f / 8.f;
+
+    // World units per pixel of the bound render target with currentView, shape quads are padded by a couple of these for antialiasing
+    static inline float pixelSize = 1.f;
+
+    // Triangles in a circle recorded by a StaticBatch2D, see drawCircle()
+    static constexpr int recordedCircleSegments = 16;
+
+    // World space bounds of currentView, see setCullingEnabled()
+    static inline Rectf cullBounds;
+    static inline bool  cullingEnabled = true;
+
+    // Draw calls made on the main thread go here, submitted command lists are merged into it by flush()
+    static inline CommandList queued;
+
+    // Command list of the calling thread, see beginCommandList()
+    static inline thread_local CommandList* activeList = nullptr;
+    static inline std::thread::id           mainThread;
+
+    static inline Mutex                submittedMutex;
+    static inline Vector<CommandList*> submittedLists;
 
     // Draw data goes here, then is sorted
-    static inline Vector<DrawCmd> drawCmds;
+    static inline Vector<DrawCmd>& drawCmds = queued.drawCmds;
+
+    // Scratch space for sorting drawCmds
+    static inline Vector<DrawCmd>  sortedCmds;
+    static inline Vector<uint64_t> sortKeys;
+    static inline Vector<uint64_t> sortKeysScratch;
+
+    // Sort key layout, most significant bits first:
+    // layer | shader | texture | draw mode | submission order
+    // Shader and texture bits are taken from the GL handles, they only need to group equal state together.
+    // Layers outside of [-2048, 2047] are clamped.
+    static constexpr int      sortOrderBits   = 24;
+    static constexpr int      sortModeBits    = 4;
+    static constexpr int      sortTextureBits = 16;
+    static constexpr int      sortShaderBits  = 8;
+    static constexpr int      sortLayerBits   = 12;
+    static constexpr uint64_t sortOrderMask   = (uint64_t(1) << sortOrderBits) - 1;
+
+    // Below this many commands a comparison sort on the keys is faster than radix sorting
+    static constexpr size_t   radixSortThreshold = 1024;
+
+    // One draw call worth of drawCmds, see buildBatches()
+    struct Batch
+    {
+        size_t   cmdBegin, cmdEnd;
+        uint32_t firstVertex, vertexCount; // Into the frame's vertices, or its instances if instanced
+        uint32_t firstIndex,  indiceCount;
+        int      textureCount;
+        Array<Texture*, maxTextureSlots> textures;
+    };
 
-    // Draw data vertex data in these two
-    // These aren't stored in the DrawCmd struct so the alloced space can be reused
-    static inline Vector<glm::vec4> posAndCoords;
-    static inline IndiceCont        indices;
+    // Where writeBatches() puts a command, indexed like drawCmds
+    struct CmdOffset
+    {
+        uint32_t vertex; // Or instance
+        uint32_t index;
+    };
+
+    // A run of whole commands, or one of parts slices of a single big command
+    struct WriteJob
+    {
+        uint32_t cmdBegin, cmdEnd;
+        uint32_t part, parts;
+    };
+
+    // Elements of each stream laid out by buildBatches()
+    struct StreamCounts
+    {
+        uint32_t vertices     = 0;
+        uint32_t indices      = 0;
+        uint32_t instances    = 0;
+        uint32_t wrapVertices = 0; // See WrapVert
+        uint32_t wrapIndices  = 0;
+
+        [[nodiscard]] size_t total() const
+        { return size_t(vertices) + indices + instances + wrapVertices + wrapIndices; }
+    };
+
+    // Where writeBatches() copies each stream to, only the ones with something in them have to be set
+    struct StreamOutput
+    {
+        PrimVert*           vertices     = nullptr;
+        uint32_t*           indices      = nullptr;
+        SpriteInstanceData* instances    = nullptr;
+        WrapVert*           wrapVertices = nullptr;
+        uint32_t*           wrapIndices  = nullptr;
+    };
+
+    static inline Vector<Batch>     batches;
+    static inline Vector<CmdOffset> cmdOffsets;
+    static inline Vector<WriteJob>  writeJobs;
+
+    // Vertices and indices copied per WriteJob
+    static constexpr uint32_t writeJobSize = 1024 * 16;
+
+    // Frames with fewer vertices, indices and instances than this are copied on one thread
+    static constexpr size_t   parallelBuildThreshold = 1024 * 64;
+
+    // See setAutoAtlasEnabled()
+    static inline TextureAutoAtlas autoAtlas;
+
+    // The glyphs of a GlyphRun in one font page, drawn with one command
+    struct GlyphRunPage
+    {
+        uint32_t page;
+        uint32_t first;    // Vertices, or instances if instanced
+        uint32_t count;
+        uint32_t indFirst;
+        uint32_t indCount;
+    };
+
+    // The quads of one drawText() string, laid out at the origin in white, see text_batch()
+    struct GlyphRun
+    {
+        String                     text;
+        const Font*                font       = nullptr;
+        uint64_t                   generation = 0;     // Font::glyphGeneration(), changes if glyphs move
+        float                      scale      = 0.f;
+        bool                       instanced  = false;
+        uint64_t                   lastUsed   = 0;     // Renderer::getFrameIndex()
+        Rectf                      bounds;
+        Vector<GlyphRunPage>       pages;              // Sorted by page
+        Vector<PrimVert>           vertices;           // Or instances if instanced
+        IndiceCont                 indices;            // Relative to the first vertex of their page
+        Vector<SpriteInstanceData> instances;
+    };
+
+    // A glyph laid out by buildGlyphRun(), before it's grouped by page
+    struct GlyphQuad
+    {
+        Rectf    dst;
+        Rectf    src;
+        uint32_t page;
+    };
+
+    struct GlyphRunCache
+    {
+        UnorderedMap<uint64_t, GlyphRun> runs;      // By glyphRunHash()
+        uint64_t                         lastSweep = 0;
+        uint32_t                         clears    = 0; // glyphRunClears when runs was last cleared
+        GlyphRun                         scratch;   // Used when the cache is disabled
+        Vector<GlyphQuad>                quads;     // Of the run being built
+    };
+
+    // Runs not drawn for this many frames are dropped, checked this often
+    static constexpr uint64_t glyphRunFrames = 120;
+
+    // See setGlyphRunCacheEnabled(), read by every thread that draws text
+    static inline Atomic<bool>               glyphRunCacheEnabled = true;
+    static inline thread_local GlyphRunCache glyphRuns;
+    static inline Atomic<uint32_t>           glyphRunClears  = 0; // Bumped when the cache is disabled, see clearStaleGlyphRuns()
+    static inline uint32_t                   cachedTextCount = 0; // Since the last flush, see Renderer2DStats::cachedText
+
+    // The triangles of one filled polygon, around the origin its points are relative to
+    struct PolygonMesh
+    {
+        Vector<Vector2f> points;
+        Vector<uint32_t> holeStarts;
+        IndiceCont       indices;           // Into points
+        Rectf            bounds;
+        float            radius   = 0.f;    // Of the circle around the origin holding every point, to cull it rotated
+        uint64_t         lastUsed = 0;      // Renderer::getFrameIndex()
+    };
+
+    struct PolygonCache
+    {
+        UnorderedMap<uint64_t, PolygonMesh> meshes;     // By polygonHash()
+        uint64_t                            lastSweep = 0;
+        uint32_t                            clears    = 0; // polygonMeshClears when meshes was last cleared
+        PolygonMesh                         scratch;    // drawPolygon(), and drawFilledPolygon() when the cache is disabled
+        Tessellator2D                       tessellator;
+    };
 
-    // These buffers are copied to the GPU
-    static inline Vector<PrimVert> batchBuffer;
-    static inline IndiceCont       batchBufferIndices;
+    // Meshes not drawn for this many frames are dropped, checked this often
+    static constexpr uint64_t polygonMeshFrames = 120;
+
+    // See setPolygonCacheEnabled(), read by every thread that draws polygons
+    static inline Atomic<bool>              polygonCacheEnabled = true;
+    static inline thread_local PolygonCache polygonMeshes;
+    static inline Atomic<uint32_t>          polygonMeshClears = 0; // Bumped when the cache is disabled, see clearStalePolygonMeshes()
+    static inline uint32_t                  cachedShapeCount  = 0; // Since the last flush, see Renderer2DStats::cachedShapes
+
+    // See setParallelBuildEnabled()
+    static inline bool             parallelBuildEnabled = true;
+    static inline UPtr<ThreadPool> buildPool;
+
+    // Draw data vertex data in these two
+    // These aren't stored in the DrawCmd struct so the alloced space can be reused.
+    // PrimVert::texIndex is filled in by writeBatches()
+    static inline Vector<PrimVert>& vertices = queued.vertices;
+    static inline IndiceCont&       indices  = queued.indices;
+
+    // Instanced sprites, see setInstancingEnabled()
+    static inline Vector<SpriteInstanceData>& instances = queued.instances;
+
+    // Sprites with uvs past their texture, their indices are in indices too
+    static inline Vector<WrapVert>& wrapVertices = queued.wrapVertices;
+
+    // Queued draw data is set aside here while a StaticBatch2D records
+    static inline bool                       recording = false;
+    static inline Vector<DrawCmd>            savedCmds;
+    static inline Vector<PrimVert>           savedVertices;
+    static inline IndiceCont                 savedIndices;
+    static inline Vector<SpriteInstanceData> savedInstances;
+    static inline Vector<WrapVert>           savedWrapVertices;
+    static inline bool                       savedCulling    = true;
+    static inline bool                       savedInstancing = false;
+
+    // Lazy font pages drawn from while recording, StaticBatch2D pins them so they aren't cleared under it
+    static inline Vector<Pair<Font*, uint32_t>> recordedFontPages;
 
     static int SDLEventFilterCB(void* userdata, SDL_Event* event)
     {
@@ -650,7 +1317,27 @@ private:
         { Renderer::create(); }
 
         if (!mesh.valid())
-        { mesh.setLayout({ TLib::Layout::Vec4f(), TLib::Layout::Vec4f() }); }
+        {
+            using TLib::Layout;
+            mesh.setLayout({ Layout::Vec2f(), Layout::Vec2usNorm(), Layout::Vec4ubNorm(), Layout::UInt() });
+            mesh.setStreamCapacity(streamVertexCapacity, streamIndiceCapacity);
+        }
+
+        if (!instanceMesh.valid())
+        {
+            using TLib::Layout;
+            Layout layout = { Layout::Vec2f(),      Layout::Vec2f(),      Layout::Vec2f(), Layout::Float(),
+                              Layout::Vec4usNorm(), Layout::Vec4ubNorm(), Layout::Float() };
+            instanceMesh.setLayout(layout.setDivisor(1));
+            instanceMesh.setStreamCapacity(streamInstanceCapacity, 0);
+        }
+
+        if (!wrapMesh.valid())
+        {
+            using TLib::Layout;
+            wrapMesh.setLayout({ Layout::Vec2f(), Layout::Vec2f(), Layout::Vec4ubNorm(), Layout::UInt() });
+            wrapMesh.setStreamCapacity(streamWrapVertexCapacity, streamWrapIndiceCapacity);
+        }
 
         if (!whiteTex.created())
         { whiteTex.setData(whiteTexData, 1, 1); }
@@ -667,96 +1354,642 @@ private:
                                myEmbeds["TLib/Embed/Shaders/sdf_text.frag"].asString().c_str());
         }
 
+        if (!instanceShader.created())
+        {
+            instanceShader.create( myEmbeds["TLib/Embed/Shaders/2d_instanced.vert"].asString().c_str(),
+                                   myEmbeds["TLib/Embed/Shaders/2d.frag"].asString().c_str());
+        }
+
+        if (!instanceTextShader.created())
+        {
+            instanceTextShader.create( myEmbeds["TLib/Embed/Shaders/2d_instanced.vert"].asString().c_str(),
+                                       myEmbeds["TLib/Embed/Shaders/sdf_text.frag"].asString().c_str());
+        }
+
+        if (!shapeShader.created())
+        {
+            shapeShader.create( myEmbeds["TLib/Embed/Shaders/2d_shape.vert"].asString().c_str(),
+                                myEmbeds["TLib/Embed/Shaders/2d_shape.frag"].asString().c_str());
+        }
+
         setSDFTextEdge(0.04f);
         setSDFTextWidth(0.48f);
 
+        // images[i] samples texture unit i
+        textureSlotCount = std::clamp(Renderer::getMaxTextureUnits(), 1, maxTextureSlots);
+        Array<GLint, maxTextureSlots> units;
+        for (int i = 0; i < maxTextureSlots; i++) { units[i] = i; }
+        for (Shader* shader : { &defaultShader, &textShader, &instanceShader, &instanceTextShader })
+        { shader->setIntArray("images", units, maxTextureSlots); }
+
         resetView();
 
         SDL_AddEventWatch(&SDLEventFilterCB, NULL);
+        mainThread             = std::this_thread::get_id();
+        FontDetail::mainThread = mainThread;
 
         size_t reserveSize = size_t(1024) * 5;
         drawCmds            .reserve(reserveSize);
-        posAndCoords        .reserve(reserveSize);
+        vertices            .reserve(reserveSize);
         indices             .reserve(reserveSize);
-        batchBuffer         .reserve(reserveSize);
-        batchBufferIndices  .reserve(reserveSize);
+        instances           .reserve(reserveSize);
+        sortedCmds          .reserve(reserveSize);
+        sortKeys            .reserve(reserveSize);
+        sortKeysScratch     .reserve(reserveSize);
         inited = true;
     }
 
-    static void flushCurrent(Shader* shader, Texture* tex, GLDrawMode drawMode)
+    // Draw calls made between these two go to the StaticBatch2D being recorded
+    static void beginRecording()
     {
-        if (batchBuffer.empty()) { return; }
+        ASSERT(inited);     // Forgot to call Renderer2D::init()
+        ASSERT(!recording); // StaticBatch2D recordings can't be nested
+
+        drawCmds    .swap(savedCmds);
+        vertices    .swap(savedVertices);
+        indices     .swap(savedIndices);
+        instances   .swap(savedInstances);
+        wrapVertices.swap(savedWrapVertices);
+
+        recordedFontPages.clear();
+
+        // Everything is recorded, and as plain vertices so it fits in one buffer
+        savedCulling      = cullingEnabled;
+        savedInstancing   = instancingEnabled;
+        cullingEnabled    = false;
+        instancingEnabled = false;
+        recording         = true;
+    }
 
-        tex->bind();
-        shader->bind();
+    static void endRecording()
+    {
+        ASSERT(recording);
 
-        shader->setMat4f("projection", currentView.getMatrix());
-        mesh.setData(batchBuffer, AccessType::Dynamic);
-        mesh.setIndices(batchBufferIndices, AccessType::Dynamic);
+        queued.clear();
 
-        RenderState rs;
-        rs.drawMode = drawMode;
-        Renderer::draw(*shader, mesh, rs);
+        drawCmds    .swap(savedCmds);
+        vertices    .swap(savedVertices);
+        indices     .swap(savedIndices);
+        instances   .swap(savedInstances);
+        wrapVertices.swap(savedWrapVertices);
 
-        batchBuffer.clear();
-        batchBufferIndices.clear();
+        cullingEnabled    = savedCulling;
+        instancingEnabled = savedInstancing;
+        recording         = false;
     }
 
-    static void flush(bool sort)
+    static uint64_t makeSortKey(const DrawCmd& cmd, size_t order)
     {
-        if (drawCmds.empty()) { return; }
+        constexpr int layerBias = 1 << (sortLayerBits - 1);
+        const uint64_t layer   = std::clamp(cmd.layer + layerBias, 0, (1 << sortLayerBits) - 1);
+        const uint64_t shader  = cmd.shader->handle()  & ((1u << sortShaderBits)  - 1);
+        const uint64_t texture = cmd.texture->handle() & ((1u << sortTextureBits) - 1);
+        const uint64_t mode    = static_cast<GLenum>(cmd.drawMode) & ((1u << sortModeBits) - 1);
+
+        uint64_t key = layer;
+        key = (key << sortShaderBits)  | shader;
+        key = (key << sortTextureBits) | texture;
+        key = (key << sortModeBits)    | mode;
+        key = (key << sortOrderBits)   | (order & sortOrderMask);
+        return key;
+    }
 
-        if (sort) { std::sort(drawCmds.begin(), drawCmds.end()); }
+    // LSD radix sort, 8 bits per pass. The submission order bits are skipped since
+    // the keys start out in submission order and every pass is stable.
+    // Passes where every key falls in the same bucket are skipped too.
+    static void radixSortKeys(Vector<uint64_t>& keys, Vector<uint64_t>& scratch)
+    {
+        scratch.resize(keys.size());
 
-        // Projection uniform for shader is set in flushCurrent()
-        // TODO: Frustum is unused for now
-        //auto mat = camera.getMatrix();
-        //frustum  = Frustum(mat);
+        for (int shift = sortOrderBits; shift < 64; shift += 8)
+        {
+            uint32_t offsets[256] = {};
+            for (const uint64_t key : keys)
+            { ++offsets[(key >> shift) & 0xFF]; }
 
-        Vector2f fbSize(Renderer::getFramebufferSize());
-        if (RenderTarget::getBoundRenderTarget())
-        { fbSize = Vector2f(RenderTarget::getBoundRenderTarget()->getSize()); }
-        Renderer::setViewport(getViewportSizePixels(currentView, fbSize));
+            if (offsets[(keys[0] >> shift) & 0xFF] == keys.size())
+            { continue; }
 
-        Texture*   lastTexture  = drawCmds[0].texture;
-        Shader*    lastShader   = drawCmds[0].shader;
-        GLDrawMode lastDrawMode = drawCmds[0].drawMode;
+            uint32_t sum = 0;
+            for (auto& offset : offsets)
+            {
+                const uint32_t count = offset;
+                offset = sum;
+                sum   += count;
+            }
 
-        // Multisample causes texture bleeding.
-        // They still happen, but are less frequent with multisample disabled
-        // To fix it completely, center your texels
-        glDisable(GL_MULTISAMPLE); 
-        glEnable(GL_PRIMITIVE_RESTART);
-        glPrimitiveRestartIndex(restartIndex);
+            for (const uint64_t key : keys)
+            { scratch[offsets[(key >> shift) & 0xFF]++] = key; }
+
+            keys.swap(scratch);
+        }
+    }
 
-        bool   stateChanged = true;
-        size_t offset = 0;
+    // Sorts drawCmds by key. Commands with equal state keep their submission order.
+    static void sortDrawCmds()
+    {
+        const size_t count = drawCmds.size();
 
-        for (auto& cmd : drawCmds)
+        // Too many commands for the submission order bits, fall back to a stable sort
+        if (count > sortOrderMask)
         {
-            stateChanged = (cmd.texture != lastTexture || cmd.shader != lastShader || cmd.drawMode != lastDrawMode);
-            if (stateChanged)
-            { flushCurrent(lastShader, lastTexture, lastDrawMode); }
+            std::stable_sort(drawCmds.begin(), drawCmds.end(), [](const DrawCmd& a, const DrawCmd& b)
+                { return (a.key >> sortOrderBits) < (b.key >> sortOrderBits); });
+            return;
+        }
 
-            offset = batchBuffer.size();
+        sortKeys.resize(count);
+        for (size_t i = 0; i < count; i++)
+        { sortKeys[i] = drawCmds[i].key; }
 
-            for (uint32_t i = cmd.indIndex; i < cmd.indIndex + cmd.indSize; i++)
-            { batchBufferIndices.push_back(offset + indices[i]); }
+        if (count < radixSortThreshold) { std::sort(sortKeys.begin(), sortKeys.end()); }
+        else                            { radixSortKeys(sortKeys, sortKeysScratch); }
 
-            batchBufferIndices.push_back(restartIndex);
+        sortedCmds.resize(count);
+        for (size_t i = 0; i < count; i++)
+        { sortedCmds[i] = drawCmds[sortKeys[i] & sortOrderMask]; }
 
-            for (uint32_t i = cmd.posIndex; i < cmd.posIndex + cmd.posSize; i++)
-            { batchBuffer.emplace_back(posAndCoords[i], cmd.color); }
+        drawCmds.swap(sortedCmds);
+    }
+
+    // Everything but the texture, see assignTextureSlot()
+    static bool sameBatch(const DrawCmd& a, const DrawCmd& b)
+    { return a.shader == b.shader && a.drawMode == b.drawMode && a.instanced == b.instanced && a.wrapped == b.wrapped; }
+
+    // True for shaders that sample through the images array, custom shaders only get slot 0
+    static bool multiTextureShader(const Shader* shader)
+    {
+        return shader == &defaultShader  || shader == &textShader ||
+               shader == &instanceShader || shader == &instanceTextShader;
+    }
+
+    // Custom shaders checkCustomShader() has seen
+    static inline Vector<GLuint> checkedShaders;
+
+    // Logs an error once per custom shader whose vertex stage still takes the inputs 2d.vert had
+    // before PrimVert (vec4 vertex and vec4 color), which read the wrong attributes now. See 2d.vert.
+    static void checkCustomShader(const Shader& shader)
+    {
+        if (multiTextureShader(&shader)) { return; }
+        if (std::find(checkedShaders.begin(), checkedShaders.end(), shader.handle()) != checkedShaders.end()) { return; }
+        checkedShaders.push_back(shader.handle());
+
+        if (glGetAttribLocation(shader.handle(), "vertex") >= 0)
+        {
+            tlog::error("Renderer2D: Shader {} takes vec4 vertex, Renderer2D's vertices are vec2 pos, vec2 texCoords, vec4 color "
+                        "and float texIndex now, see 2d.vert", shader.handle());
+        }
+    }
+
+    // Gives cmd a texture slot in the batch being built, false if the slots ran out
+    static bool assignTextureSlot(DrawCmd& cmd)
+    {
+        for (int i = 0; i < batchTextureCount; i++)
+        {
+            if (batchTextures[i] == cmd.texture)
+            { cmd.texSlot = i; return true; }
+        }
+
+        if (batchTextureCount == textureSlotCount) { return false; }
+        if (batchTextureCount > 0 && !multiTextureShader(cmd.shader)) { return false; }
+
+        cmd.texSlot = batchTextureCount;
+        batchTextures[batchTextureCount++] = cmd.texture;
+        return true;
+    }
+
+    /*
+    Lays drawCmds out back to back, one Batch per run found by forEachBatch().
+    Vertex path commands go in one vertex and index buffer, instanced ones in one instance buffer,
+    and wrapped ones in a vertex and index buffer of their own.
+    Also splits the copy done by writeBatches() into writeJobs.
+    */
+    static void buildBatches(StreamCounts& counts)
+    {
+        batches  .clear();
+        writeJobs.clear();
+        cmdOffsets.resize(drawCmds.size());
+        counts = StreamCounts();
+
+        uint32_t jobBegin = 0;
+        uint32_t jobSize  = 0;
+        auto endJob = [&](uint32_t end)
+        {
+            if (end > jobBegin) { writeJobs.push_back({ jobBegin, end, 0, 1 }); }
+            jobBegin = end;
+            jobSize  = 0;
+        };
+
+        forEachBatch([&](size_t begin, size_t end)
+        {
+            const DrawCmd& first     = drawCmds[begin];
+            const bool     instanced = first.instanced;
+            uint32_t&      head      = instanced ? counts.instances : first.wrapped ? counts.wrapVertices : counts.vertices;
+            uint32_t&      indHead   = first.wrapped ? counts.wrapIndices : counts.indices;
+
+            Batch& batch       = batches.emplace_back();
+            batch.cmdBegin     = begin;
+            batch.cmdEnd       = end;
+            batch.firstVertex  = head;
+            batch.firstIndex   = indHead;
+            batch.textureCount = batchTextureCount;
+            batch.textures     = batchTextures;
+
+            for (size_t c = begin; c < end; c++)
+            {
+                const DrawCmd& cmd        = drawCmds[c];
+                const uint32_t cmdIndices = instanced ? 0 : cmd.indSize + 1; // + restart index
+                cmdOffsets[c] = { head, indHead };
+                head    += cmd.posSize;
+                indHead += cmdIndices;
+
+                // Commands from drawTextures() and the like can be huge, they're split so they don't end up on one thread
+                const uint32_t size = cmd.posSize + cmdIndices;
+                if (size > writeJobSize)
+                {
+                    endJob(c);
+                    const uint32_t parts = (size + writeJobSize - 1) / writeJobSize;
+                    for (uint32_t part = 0; part < parts; part++)
+                    { writeJobs.push_back({ uint32_t(c), uint32_t(c + 1), part, parts }); }
+                    jobBegin = c + 1;
+                    continue;
+                }
+
+                jobSize += size;
+                if (jobSize >= writeJobSize) { endJob(c + 1); }
+            }
+
+            batch.vertexCount = head    - batch.firstVertex;
+            batch.indiceCount = indHead - batch.firstIndex;
+        });
+
+        endJob(drawCmds.size());
+    }
+
+    // Copies the commands of one WriteJob to where buildBatches() placed them.
+    // Indices are offset so they're relative to the first vertex of their stream.
+    static void writeJob(const WriteJob& job, const StreamOutput& out)
+    {
+        for (uint32_t c = job.cmdBegin; c < job.cmdEnd; c++)
+        {
+            const DrawCmd&   cmd    = drawCmds[c];
+            const CmdOffset& offset = cmdOffsets[c];
+
+            // This job's share of the command
+            const uint32_t posBegin = uint64_t(cmd.posSize) *  job.part      / job.parts;
+            const uint32_t posEnd   = uint64_t(cmd.posSize) * (job.part + 1) / job.parts;
+
+            if (cmd.instanced)
+            {
+                for (uint32_t i = posBegin; i < posEnd; i++)
+                {
+                    SpriteInstanceData inst = instances[cmd.posIndex + i];
+                    inst.texIndex = cmd.texSlot;
+                    out.instances[offset.vertex + i] = inst;
+                }
+                continue;
+            }
+
+            uint32_t* indOut = out.indices;
+            if (cmd.wrapped)
+            {
+                for (uint32_t i = posBegin; i < posEnd; i++)
+                {
+                    WrapVert vert = wrapVertices[cmd.posIndex + i];
+                    vert.texIndex = cmd.texSlot;
+                    out.wrapVertices[offset.vertex + i] = vert;
+                }
+                indOut = out.wrapIndices;
+            }
+            else
+            {
+                for (uint32_t i = posBegin; i < posEnd; i++)
+                {
+                    PrimVert vert = vertices[cmd.posIndex + i];
+                    vert.texIndex = cmd.texSlot;
+                    out.vertices[offset.vertex + i] = vert;
+                }
+            }
+
+            const uint32_t indBegin = uint64_t(cmd.indSize) *  job.part      / job.parts;
+            const uint32_t indEnd   = uint64_t(cmd.indSize) * (job.part + 1) / job.parts;
+            for (uint32_t i = indBegin; i < indEnd; i++)
+            { indOut[offset.index + i] = offset.vertex + indices[cmd.indIndex + i]; }
+
+            if (job.part + 1 == job.parts)
+            { indOut[offset.index + cmd.indSize] = restartIndex; }
+        }
+    }
+
+    // Runs every job from buildBatches(), on the worker pool when there's enough to copy
+    static void writeBatches(const StreamOutput& out, size_t elementCount)
+    {
+        auto write = [&](size_t begin, size_t end)
+        {
+            for (size_t j = begin; j < end; j++)
+            { writeJob(writeJobs[j], out); }
+        };
+
+        if (!parallelBuildEnabled || elementCount < parallelBuildThreshold || writeJobs.size() < 2)
+        {
+            write(0, writeJobs.size());
+            return;
+        }
+
+        if (!buildPool) { buildPool = makeUnique<ThreadPool>(); }
+        buildPool->parallelFor(writeJobs.size(), 1, write);
+    }
+
+    // Draws one batch written by writeBatches() into the mapped stream ranges
+    static void drawBatch(const Batch&                                          batch,
+                          const GPUVertexData::StreamRange<PrimVert>&           vertexRange,
+                          const GPUVertexData::StreamRange<SpriteInstanceData>& instanceRange,
+                          const GPUVertexData::StreamRange<WrapVert>&           wrapRange)
+    {
+        // Slot 0 last so it's the active unit afterwards, like after a plain Texture::bind()
+        for (int i = batch.textureCount - 1; i >= 0; i--)
+        { batch.textures[i]->bind(i); }
+
+        const DrawCmd& first = drawCmds[batch.cmdBegin];
+        checkCustomShader(*first.shader);
+        first.shader->bind();
+        first.shader->setMat4f("projection", currentView.getMatrix());
+
+        RenderState rs;
+        if (first.instanced)
+        {
+            GPUVertexData::StreamRange<SpriteInstanceData> range = instanceRange;
+            range.baseVertex += batch.firstVertex;
+            range.vertexCount = batch.vertexCount;
+
+            rs.drawMode = GLDrawMode::TriangleStrip;
+            Renderer::drawInstanced(*first.shader, instanceMesh, range, 4, rs);
+        }
+        else if (first.wrapped)
+        {
+            rs.drawMode = first.drawMode;
+            Renderer::drawRange(*first.shader, wrapMesh, batch.indiceCount, wrapRange.firstIndex + batch.firstIndex,
+                                wrapRange.baseVertex, rs);
+        }
+        else
+        {
+            rs.drawMode = first.drawMode;
+            Renderer::drawRange(*first.shader, mesh, batch.indiceCount, vertexRange.firstIndex + batch.firstIndex,
+                                vertexRange.baseVertex, rs);
+        }
+    }
+
+    // Viewport and GL state for drawing with currentView
+    static void prepareState()
+    {
+        Renderer::setViewport(getViewportSizePixels(currentView, targetSize()));
+
+        // Multisample causes texture bleeding.
+        // They still happen, but are less frequent with multisample disabled
+        // To fix it completely, center your texels
+        glDisable(GL_MULTISAMPLE); 
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(restartIndex);
+    }
+
+    /*
+    Calls fn(begin, end) for each run of drawCmds sharing the same state,
+    with batchTextures holding the textures of the run.
+    Texture changes only end a run once the texture slots run out.
+    */
+    template <typename Fn>
+    static void forEachBatch(Fn&& fn)
+    {
+        if (drawCmds.empty()) { return; }
+
+        size_t batchBegin = 0;
+        batchTextureCount = 0;
+        assignTextureSlot(drawCmds[0]);
+        for (size_t c = 1; c < drawCmds.size(); c++)
+        {
+            if (sameBatch(drawCmds[c], drawCmds[batchBegin]) && assignTextureSlot(drawCmds[c])) { continue; }
+            fn(batchBegin, c);
+            batchBegin        = c;
+            batchTextureCount = 0;
+            assignTextureSlot(drawCmds[c]);
+        }
+
+        fn(batchBegin, drawCmds.size());
+    }
+
+    // Where draw calls made on this thread go
+    static CommandList& target()
+    {
+        if (activeList) { return *activeList; }
+        ASSERT(std::this_thread::get_id() == mainThread); // Draw calls on other threads need a command list, see beginCommandList()
+        return queued;
+    }
+
+    // Appends the submitted command lists to the main thread's draw calls and clears them
+    static void mergeCommandLists()
+    {
+        LockGuard lock(submittedMutex);
+
+        for (CommandList* list : submittedLists)
+        {
+            const uint32_t vertexBase   = vertices.size();
+            const uint32_t indiceBase   = indices.size();
+            const uint32_t instanceBase = instances.size();
+            const uint32_t wrapBase     = wrapVertices.size();
+
+            // Indices are relative to their command's first vertex, only the ranges move
+            drawCmds.reserve(drawCmds.size() + list->drawCmds.size());
+            for (DrawCmd cmd : list->drawCmds)
+            {
+                cmd.posIndex += cmd.instanced ? instanceBase : cmd.wrapped ? wrapBase : vertexBase;
+                cmd.indIndex += indiceBase;
+                cmd.key       = (cmd.key & ~sortOrderMask) | (drawCmds.size() & sortOrderMask);
+                drawCmds.push_back(cmd);
+            }
+
+            vertices    .insert(vertices.end(),     list->vertices.begin(),     list->vertices.end());
+            indices     .insert(indices.end(),      list->indices.begin(),      list->indices.end());
+            instances   .insert(instances.end(),    list->instances.begin(),    list->instances.end());
+            wrapVertices.insert(wrapVertices.end(), list->wrapVertices.begin(), list->wrapVertices.end());
+            list->clear();
+        }
+
+        submittedLists.clear();
+    }
+
+    // With several frames in flight, moves the streams to the region of the new frame on the first flush after a swap
+    static void beginStreamFrame()
+    {
+        const uint32_t frames = Renderer::getFramesInFlight();
+        if (mesh.streamFrameCount() != frames)
+        {
+            mesh        .setStreamFrameCount(frames);
+            instanceMesh.setStreamFrameCount(frames);
+            wrapMesh    .setStreamFrameCount(frames);
+        }
+
+        if (streamFrameIndex != Renderer::getFrameIndex())
+        {
+            streamFrameIndex = Renderer::getFrameIndex();
+            mesh        .beginStreamFrame();
+            instanceMesh.beginStreamFrame();
+            wrapMesh    .beginStreamFrame();
+        }
+    }
+
+    // Sprites drawn with the default shaders, custom shaders may need the whole texture.
+    // Wrapped sprites need the texture's own UV mode, an atlas can't repeat one texture in it.
+    static bool autoAtlasCandidate(const DrawCmd& cmd)
+    {
+        return (cmd.shader == &defaultShader || cmd.shader == &instanceShader) && !cmd.wrapped &&
+                cmd.texture != &whiteTex && autoAtlas.accepts(*cmd.texture);
+    }
+
+    static inline uint16_t remapUnorm16(uint16_t v, float offset, float scale)
+    { return toUnorm16(offset + float(v) * (scale / 65535.f)); }
+
+    // Moves the commands whose texture is in an auto atlas to the atlas, before they're sorted
+    static void autoAtlasDrawCmds()
+    {
+        // Commands of the same texture are often next to each other, only tell the atlas once
+        Texture* last = nullptr;
+        for (const DrawCmd& cmd : drawCmds)
+        {
+            if (cmd.texture == last || !autoAtlasCandidate(cmd)) { continue; }
+            last = cmd.texture;
+            autoAtlas.use(*cmd.texture);
+        }
+
+        autoAtlas.update(Renderer::getFrameIndex());
+
+        const TextureAutoAtlas::Placement* place = nullptr;
+        last = nullptr;
+        for (DrawCmd& cmd : drawCmds)
+        {
+            if (!autoAtlasCandidate(cmd)) { continue; }
+            if (cmd.texture != last)
+            {
+                last  = cmd.texture;
+                place = autoAtlas.find(*cmd.texture);
+            }
+            if (!place) { continue; }
+
+            const Vector2f& off   = place->uvOffset;
+            const Vector2f& scale = place->uvScale;
+            if (cmd.instanced)
+            {
+                for (SpriteInstanceData& inst : std::span(instances.data() + cmd.posIndex, cmd.posSize))
+                {
+                    inst.uv[0] = remapUnorm16(inst.uv[0], off.x, scale.x);
+                    inst.uv[1] = remapUnorm16(inst.uv[1], off.y, scale.y);
+                    inst.uv[2] = remapUnorm16(inst.uv[2], off.x, scale.x);
+                    inst.uv[3] = remapUnorm16(inst.uv[3], off.y, scale.y);
+                }
+            }
+            else
+            {
+                for (PrimVert& vert : std::span(vertices.data() + cmd.posIndex, cmd.posSize))
+                {
+                    vert.u = remapUnorm16(vert.u, off.x, scale.x);
+                    vert.v = remapUnorm16(vert.v, off.y, scale.y);
+                }
+            }
 
-            lastTexture  = cmd.texture;
-            lastShader   = cmd.shader;
-            lastDrawMode = cmd.drawMode;
+            cmd.texture = place->atlas;
+            cmd.key     = makeSortKey(cmd, cmd.key & sortOrderMask);
+            ++stats.atlased;
         }
+    }
 
-        flushCurrent(lastShader, lastTexture, lastDrawMode);
-        drawCmds.clear();
-        posAndCoords.clear();
-        indices.clear();
+    static void beginStatsFrame()
+    {
+        if (statsFrameIndex == Renderer::getFrameIndex()) { return; }
+        statsFrameIndex = Renderer::getFrameIndex();
+        std::swap(stats, lastStats);
+        stats.clear();
+    }
+
+    // Counts the batches of the flush and why each one after the first had to be started
+    static void countBatches()
+    {
+        stats.batches += batches.size();
+
+        for (size_t b = 1; b < batches.size(); b++)
+        {
+            const DrawCmd& prev = drawCmds[batches[b - 1].cmdBegin];
+            const DrawCmd& cmd  = drawCmds[batches[b].cmdBegin];
+
+            // Same order as the checks in sameBatch(), anything else is the texture
+            Renderer2DBatchBreak reason = Renderer2DBatchBreak::Texture;
+            if      (cmd.shader    != prev.shader)    { reason = Renderer2DBatchBreak::Shader;     }
+            else if (cmd.drawMode  != prev.drawMode)  { reason = Renderer2DBatchBreak::DrawMode;   }
+            else if (cmd.instanced != prev.instanced) { reason = Renderer2DBatchBreak::Instancing; }
+            else if (cmd.wrapped   != prev.wrapped)   { reason = Renderer2DBatchBreak::WrappedUVs; }
+
+            ++stats.breaks[size_t(reason)];
+            stats.breakLog.push_back({ reason, cmd.layer, cmd.texture, cmd.shader, cmd.drawMode });
+        }
+    }
+
+    static void flush(bool sort)
+    {
+        beginStatsFrame();
+        mergeCommandLists();
+        stats.cachedText   += std::exchange(cachedTextCount,  0);
+        stats.cachedShapes += std::exchange(cachedShapeCount, 0);
+        if (drawCmds.empty()) { return; }
+
+        ++stats.flushes;
+        stats.commands += drawCmds.size();
+
+        if (autoAtlas.created()) { autoAtlasDrawCmds(); }
+
+        Timer timer;
+        if (sort) { sortDrawCmds(); }
+        stats.sortMs += timer.restart().asSeconds() * 1000.0;
+
+        // Projection uniform for shader is set in drawBatch()
+        prepareState();
+        timer.restart();
+
+        // Build: lay the batches out and copy the frame's draw data into the streams, in parallel if it's big
+        StreamCounts counts;
+        buildBatches(counts);
+
+        beginStreamFrame();
+        GPUVertexData::StreamRange<PrimVert>           vertexRange;
+        GPUVertexData::StreamRange<SpriteInstanceData> instanceRange;
+        GPUVertexData::StreamRange<WrapVert>           wrapRange;
+        if (counts.vertices     > 0) { vertexRange   = mesh        .mapStream<PrimVert>          (counts.vertices, counts.indices);         }
+        if (counts.instances    > 0) { instanceRange = instanceMesh.mapStream<SpriteInstanceData>(counts.instances, 0);                     }
+        if (counts.wrapVertices > 0) { wrapRange     = wrapMesh    .mapStream<WrapVert>          (counts.wrapVertices, counts.wrapIndices); }
+
+        writeBatches({ vertexRange.vertices, vertexRange.indices, instanceRange.vertices, wrapRange.vertices, wrapRange.indices },
+                     counts.total());
+
+        if (counts.vertices     > 0) { mesh        .unmapStream(); }
+        if (counts.instances    > 0) { instanceMesh.unmapStream(); }
+        if (counts.wrapVertices > 0) { wrapMesh    .unmapStream(); }
+
+        stats.buildMs       += timer.getElapsedTime().asSeconds() * 1000.0;
+        stats.vertices      += counts.vertices + counts.wrapVertices;
+        stats.indices       += counts.indices  + counts.wrapIndices;
+        stats.instances     += counts.instances;
+        stats.bytesUploaded += size_t(counts.vertices)     * sizeof(PrimVert) +
+                               size_t(counts.indices + counts.wrapIndices) * sizeof(uint32_t) +
+                               size_t(counts.instances)    * sizeof(SpriteInstanceData) +
+                               size_t(counts.wrapVertices) * sizeof(WrapVert);
+        countBatches();
+
+        // Submit: one draw call per batch, GL stays on this thread
+        for (const Batch& batch : batches)
+        { drawBatch(batch, vertexRange, instanceRange, wrapRange); }
+
+        if (counts.vertices     > 0) { mesh        .fenceStream(); }
+        if (counts.instances    > 0) { instanceMesh.fenceStream(); }
+        if (counts.wrapVertices > 0) { wrapMesh    .fenceStream(); }
+
+        queued.clear();
     }
 
     static void rotate(float& x, float& y, float radians)
@@ -769,167 +2002,1188 @@ private:
         y = xcopy * sinv + ycopy * cosv;
     }
 
+    static inline uint16_t toUnorm16(float v)
+    { return static_cast<uint16_t>(std::clamp(v, 0.f, 1.f) * 65535.f + 0.5f); }
+
+    static inline PrimVert makeVert(float x, float y, float u, float v, const ColorRGBAi& color)
+    { return { Vector2f(x, y), toUnorm16(u), toUnorm16(v), color, 0 }; }
+
+    // True if a draw call covering rect should be thrown away
+    static inline bool culled(const Rectf& rect, bool cull)
+    { return cull && cullingEnabled && !isVisible(rect); }
+
     // Rotation is in radians
-    static DrawCmd& sprite_batch(      Texture&          texture,
-                                 const Rectf&            srcrect,
-                                 const Rectf&            dstrect,
-                                 const float             rotation = 0.f,
-                                 const ColorRGBAf&       color    = { 1.f, 1.f, 1.f, 1.f },
-                                 const int               layer    = 0,
-                                 const Renderer2DOrigin& origin   = OriginCenter,
-                                 const bool              flipuvx  = false,
-                                 const bool              flipuvy  = false,
-                                 Shader&                 shader   = defaultShader)
+    static void sprite_batch(      Texture&          texture,
+                             const Rectf&            srcrect,
+                             const Rectf&            dstrect,
+                             const float             rotation = 0.f,
+                             const ColorRGBAf&       color    = { 1.f, 1.f, 1.f, 1.f },
+                             const int               layer    = 0,
+                             const Renderer2DOrigin& origin   = OriginCenter,
+                             const bool              flipuvx  = false,
+                             const bool              flipuvy  = false,
+                             Shader&                 shader   = defaultShader,
+                             const bool              cull     = true)
     {
         ASSERT(inited); // Forgot to call Renderer2D::init()
-        drawCmds.emplace_back();
-        DrawCmd& cmd = drawCmds.back();
+
+        Vector2f realOrigin;
+        if (rotation != 0)
+        {
+            // If origin is default value, make it center of texture
+            if (origin.pos.x == FLT_MAX)
+            { realOrigin = getRectDefaultOrigin(dstrect); }
+            else
+            {
+                if (origin.useWorldCoords)
+                { realOrigin = origin.pos; }
+                else
+                { realOrigin = Vector2f(dstrect.x, dstrect.y) + origin.pos; }
+            }
+
+            if (cull && cullingEnabled)
+            {
+                // Rotated sprites are tested with the box around the circle they can sweep,
+                // which is cheaper than rotating the corners first and still never culls visible sprites
+                const float dx     = std::max(std::abs(dstrect.x - realOrigin.x), std::abs(dstrect.getRight()  - realOrigin.x));
+                const float dy     = std::max(std::abs(dstrect.y - realOrigin.y), std::abs(dstrect.getBottom() - realOrigin.y));
+                const float radius = std::sqrt(dx * dx + dy * dy);
+                if (!isVisible(Rectf(realOrigin.x - radius, realOrigin.y - radius, radius * 2.f, radius * 2.f)))
+                { return; }
+            }
+        }
+        else if (culled(dstrect, cull)) { return; }
+
+        Pair<Vector2f, Vector2f> uv = getTextureUVs(texture, srcrect);
+        if (flipuvx) { std::swap(uv.first.x, uv.second.x); }
+        if (flipuvy) { std::swap(uv.first.y, uv.second.y); }
+
+        // srcrect reaches past the texture, which the packed uvs can't hold
+        if (!uvsInUnitRange(uv))
+        {
+            wrapped_sprite_batch(texture, uv, dstrect, rotation, color, layer, realOrigin, shader);
+            return;
+        }
+
+        if (instancingEnabled && (&shader == &defaultShader || &shader == &textShader))
+        {
+            instance_batch(texture, uv, dstrect, rotation, color, layer, realOrigin,
+                           &shader == &textShader ? instanceTextShader : instanceShader);
+            return;
+        }
+
+        CommandList& list = target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
 
         cmd.texture  = &texture;
         cmd.shader   = &shader;
         cmd.layer    = layer;
         cmd.drawMode = GLDrawMode::Triangles;
-        cmd.color    = color;
+        cmd.key      = makeSortKey(cmd, list.drawCmds.size() - 1);
 
-        cmd.indIndex = indices.size();
+        cmd.indIndex = list.indices.size();
         cmd.indSize  = sprite_indices.size();
-        indices.insert(indices.end(), sprite_indices.begin(), sprite_indices.end());
+        list.indices.insert(list.indices.end(), sprite_indices.begin(), sprite_indices.end());
 
-        cmd.posIndex = posAndCoords.size();
+        cmd.posIndex = list.vertices.size();
         cmd.posSize  = 4;
 
         float xpluswidth  = dstrect.x + dstrect.width;
         float yplusheight = dstrect.y + dstrect.height;
 
-        Pair<Vector2f, Vector2f> uv = getTextureUVs(texture, srcrect);
         auto& uv_x      = uv.first.x;
         auto& uv_y      = uv.first.y;
         auto& uv_width  = uv.second.x;
         auto& uv_height = uv.second.y;
 
-        if (flipuvx)
-        { std::swap(uv_x, uv_width); }
-        if (flipuvy)
-        { std::swap(uv_y, uv_height); }
-
         //uv_x,      uv_y       // topleft
         //uv_width,  uv_y       // topright
         //uv_x,      uv_height  // bottom left
         //uv_width,  uv_height  // bottom right
 
-        posAndCoords.emplace_back( dstrect.x , dstrect.y  , uv_x    , uv_y      ); // bottom left 
-        posAndCoords.emplace_back( xpluswidth, dstrect.y  , uv_width, uv_y      ); // bottom right 
-        posAndCoords.emplace_back( dstrect.x , yplusheight, uv_x    , uv_height ); // topleft
-        posAndCoords.emplace_back( xpluswidth, yplusheight, uv_width, uv_height ); // topright
+        const ColorRGBAi packedColor = color.toRGBAi();
+        list.vertices.push_back(makeVert( dstrect.x , dstrect.y  , uv_x    , uv_y     , packedColor )); // bottom left 
+        list.vertices.push_back(makeVert( xpluswidth, dstrect.y  , uv_width, uv_y     , packedColor )); // bottom right 
+        list.vertices.push_back(makeVert( dstrect.x , yplusheight, uv_x    , uv_height, packedColor )); // topleft
+        list.vertices.push_back(makeVert( xpluswidth, yplusheight, uv_width, uv_height, packedColor )); // topright
          
         if (rotation != 0)
         {
-            Vector2f realOrigin;
+            for (size_t i = list.vertices.size() - 4; i < list.vertices.size(); i++)
+            {
+                auto& v = list.vertices[i].pos;
+                v.x -= realOrigin.x; v.y -= realOrigin.y;
+                rotate(v.x, v.y, rotation);
+                v.x += realOrigin.x; v.y += realOrigin.y;
+            }
+        }
+    }
 
-            // If origin is default value, make it center of texture
-            if (origin.pos.x == FLT_MAX)
-            { realOrigin = getRectDefaultOrigin(dstrect); }
-            else
+    static inline bool uvsInUnitRange(const Pair<Vector2f, Vector2f>& uv)
+    {
+        return std::min({ uv.first.x, uv.first.y, uv.second.x, uv.second.y }) >= 0.f &&
+               std::max({ uv.first.x, uv.first.y, uv.second.x, uv.second.y }) <= 1.f;
+    }
+
+    // sprite_batch() for uvs outside [0, 1]. One quad with the uvs kept as floats in wrapVertices,
+    // so the texture's UV mode wraps them on the GPU like it did before the packed vertices.
+    static void wrapped_sprite_batch(      Texture&                  texture,
+                                     const Pair<Vector2f, Vector2f>& uv,
+                                     const Rectf&                    dstrect,
+                                     const float                     rotation,
+                                     const ColorRGBAf&               color,
+                                     const int                       layer,
+                                     const Vector2f&                 realOrigin,
+                                     Shader&                         shader)
+    {
+        CommandList& list = target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture  = &texture;
+        cmd.shader   = &shader;
+        cmd.layer    = layer;
+        cmd.drawMode = GLDrawMode::Triangles;
+        cmd.wrapped  = true;
+        cmd.key      = makeSortKey(cmd, list.drawCmds.size() - 1);
+
+        cmd.indIndex = list.indices.size();
+        cmd.indSize  = sprite_indices.size();
+        list.indices.insert(list.indices.end(), sprite_indices.begin(), sprite_indices.end());
+
+        cmd.posIndex = list.wrapVertices.size();
+        cmd.posSize  = 4;
+
+        const float      xpluswidth  = dstrect.x + dstrect.width;
+        const float      yplusheight = dstrect.y + dstrect.height;
+        const ColorRGBAi packedColor = color.toRGBAi();
+        list.wrapVertices.push_back({ { dstrect.x , dstrect.y   }, { uv.first.x , uv.first.y  }, packedColor, 0 });
+        list.wrapVertices.push_back({ { xpluswidth, dstrect.y   }, { uv.second.x, uv.first.y  }, packedColor, 0 });
+        list.wrapVertices.push_back({ { dstrect.x , yplusheight }, { uv.first.x , uv.second.y }, packedColor, 0 });
+        list.wrapVertices.push_back({ { xpluswidth, yplusheight }, { uv.second.x, uv.second.y }, packedColor, 0 });
+
+        if (rotation != 0)
+        {
+            for (WrapVert& vert : std::span(list.wrapVertices.data() + cmd.posIndex, cmd.posSize))
             {
-                if (origin.useWorldCoords)
-                { realOrigin = origin.pos; }
-                else
-                { realOrigin = Vector2f(dstrect.x, dstrect.y) + origin.pos; }
+                vert.pos -= realOrigin;
+                rotate(vert.pos.x, vert.pos.y, rotation);
+                vert.pos += realOrigin;
             }
+        }
+    }
+
+    // Instanced version of sprite_batch(), uv is already flipped and inside [0, 1].
+    // realOrigin is in world space and only read if rotation != 0.
+    static void instance_batch(      Texture&                  texture,
+                               const Pair<Vector2f, Vector2f>& uv,
+                               const Rectf&                    dstrect,
+                               const float                     rotation,
+                               const ColorRGBAf&               color,
+                               const int                       layer,
+                               const Vector2f&                 realOrigin,
+                               Shader&                         shader)
+    {
+        CommandList& list = target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture   = &texture;
+        cmd.shader    = &shader;
+        cmd.layer     = layer;
+        cmd.drawMode  = GLDrawMode::TriangleStrip;
+        cmd.instanced = true;
+        cmd.key       = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex  = list.instances.size();
+        cmd.posSize   = 1;
+        cmd.indIndex  = 0;
+        cmd.indSize   = 0;
+
+        SpriteInstanceData& inst = list.instances.emplace_back();
+        inst.pos      = Vector2f(dstrect.x, dstrect.y);
+        inst.size     = Vector2f(dstrect.width, dstrect.height);
+        inst.origin   = rotation != 0 ? realOrigin - inst.pos : Vector2f(0.f, 0.f);
+        inst.rotation = rotation;
+        inst.uv[0]    = toUnorm16(uv.first.x);
+        inst.uv[1]    = toUnorm16(uv.first.y);
+        inst.uv[2]    = toUnorm16(uv.second.x);
+        inst.uv[3]    = toUnorm16(uv.second.y);
+        inst.color    = color.toRGBAi();
+    }
 
-            for (size_t i = posAndCoords.size() - 4; i < posAndCoords.size(); i++)
+    // Outline of a rounded box, for StaticBatch2D recordings
+    static void roundedBoxPoints(Vector<Vector2f>& points,
+                                 const Vector2f&   center,
+                                 const Vector2f&   halfSize,
+                                 const float       radius,
+                                 const float       rotation)
+    {
+        points.clear();
+
+        // Quarter circle segments per corner, sharp corners are one point
+        const int      arcSegments = radius >= 0.5f ? std::clamp(int(radius / 2.f), 2, 16) : 0;
+        const Vector2f inner(halfSize.x - radius, halfSize.y - radius);
+        const Vector2f corners[4] = { { inner.x, inner.y }, { -inner.x, inner.y }, { -inner.x, -inner.y }, { inner.x, -inner.y } };
+
+        for (int c = 0; c < 4; c++)
+        {
+            for (int i = 0; i <= arcSegments; i++)
             {
-                auto& v = posAndCoords[i];
-                v.x -= realOrigin.x; v.y -= realOrigin.y;
-                rotate(v.x, v.y, rotation);
-                v.x += realOrigin.x; v.y += realOrigin.y;
+                const float angle = (float(c) + (arcSegments > 0 ? float(i) / float(arcSegments) : 0.f)) * 3.1415926f / 2.f;
+                Vector2f    point = corners[c] + Vector2f(std::cos(angle), std::sin(angle)) * radius;
+                if (rotation != 0.f) { point.rotate(rotation); }
+                points.push_back(center + point);
             }
         }
+    }
+
+    /*
+    Every shape is a box with rounded corners, drawn as one instance of shapeShader. The uvs of the
+    instance hold the corner radius, the outline thickness (0 fills it) and the padding, over half the
+    quad's smaller side, since the shader doesn't sample a texture. Outlines are inside the box's edge.
+    */
+    static void shape_batch(const Vector2f&   center,
+                            const Vector2f&   halfSize,
+                                  float       radius,
+                                  float       thickness,
+                            const float       rotation,
+                            const ColorRGBAf& color,
+                            const int         layer,
+                            const bool        cull)
+    {
+        ASSERT(inited); // Forgot to call Renderer2D::init()
+
+        if (halfSize.x <= 0.f || halfSize.y <= 0.f) { return; }
+        const float smaller = std::min(halfSize.x, halfSize.y);
+        radius    = std::clamp(radius, 0.f, smaller);
+        thickness = thickness >= smaller ? 0.f : std::max(thickness, 0.f);
+
+        // Rotated shapes are tested with the box around the circle they can sweep, like sprites
+        const Vector2f reach = rotation != 0.f ? Vector2f(halfSize.length(), halfSize.length()) : halfSize;
+        if (culled(Rectf(center - reach, reach * 2.f), cull)) { return; }
 
-        return cmd;
+        if (recording)
+        {
+            auto& points = target().points;
+            if (thickness == 0.f)
+            {
+                roundedBoxPoints(points, center, halfSize, radius, rotation);
+                prim_batch(points, color, GLDrawMode::TriangleFan, layer, false);
+                return;
+            }
+
+            // A line loop down the middle of the outline
+            const float inset = thickness * 0.5f;
+            roundedBoxPoints(points, center, halfSize - Vector2f(inset, inset), std::max(radius - inset, 0.f), rotation);
+            const float savedWidth = lineWidth;
+            lineWidth = thickness;
+            prim_batch(points, color, GLDrawMode::LineLoop, layer, false);
+            lineWidth = savedWidth;
+            return;
+        }
+
+        const float    pad  = pixelSize * 2.f;
+        const Vector2f half = halfSize + Vector2f(pad, pad);
+        const float    unit = std::min(half.x, half.y);
+
+        CommandList& list = target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture   = &whiteTex;
+        cmd.shader    = &shapeShader;
+        cmd.layer     = layer;
+        cmd.drawMode  = GLDrawMode::TriangleStrip;
+        cmd.instanced = true;
+        cmd.key       = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex  = list.instances.size();
+        cmd.posSize   = 1;
+        cmd.indIndex  = 0;
+        cmd.indSize   = 0;
+
+        SpriteInstanceData& inst = list.instances.emplace_back();
+        inst.pos      = center - half;
+        inst.size     = half * 2.f;
+        inst.origin   = half;
+        inst.rotation = rotation;
+        inst.uv[0]    = toUnorm16(radius    / unit);
+        inst.uv[1]    = toUnorm16(thickness / unit);
+        inst.uv[2]    = toUnorm16(pad       / unit);
+        inst.uv[3]    = 0;
+        inst.color    = color.toRGBAi();
     }
 
+    // drawTextures() implementation, one command for all of the sprites
+    static void sprites_batch(      Texture&                        texture,
+                              const std::span<const SpriteInstance> sprites,
+                              const int                             layer,
+                              Shader&                               shader,
+                              const bool                            cull)
+    {
+        using namespace simd;
+        ASSERT(inited); // Forgot to call Renderer2D::init()
+        CommandList& list = target();
+        if (sprites.empty()) { return; }
+
+        const bool instanced = instancingEnabled && (&shader == &defaultShader || &shader == &textShader);
+
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture   = &texture;
+        cmd.shader    = instanced ? (&shader == &textShader ? &instanceTextShader : &instanceShader) : &shader;
+        cmd.layer     = layer;
+        cmd.drawMode  = instanced ? GLDrawMode::TriangleStrip : GLDrawMode::Triangles;
+        cmd.instanced = instanced;
+        cmd.key       = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex  = instanced ? list.instances.size() : list.vertices.size();
+        cmd.indIndex  = list.indices.size();
+
+        const Vector2f invTexSize = Vector2f(1.f, 1.f) / Vector2f(texture.getSize());
+        const bool     doCull     = cull && cullingEnabled;
+
+        // Bounds of the view, see isVisible()
+        const Float4 viewLeft   = Float4::set1(cullBounds.x);
+        const Float4 viewRight  = Float4::set1(cullBounds.getRight());
+        const Float4 viewTop    = Float4::set1(cullBounds.y);
+        const Float4 viewBottom = Float4::set1(cullBounds.getBottom());
+        const Float4 zero       = Float4::set1(0.f);
+        const Float4 half       = Float4::set1(0.5f);
+
+        uint32_t         written = 0;
+        Vector<uint32_t> wrapped; // Sprites whose srcrect reaches past the texture, see wrapped_sprite_batch()
+        for (size_t base = 0; base < sprites.size(); base += 4)
+        {
+            const size_t lanes = std::min<size_t>(4, sprites.size() - base);
+
+            // Sprites are stored one after the other, the math wants each field in its own register
+            alignas(16) float px[4] = {}, py[4] = {}, w[4] = {}, h[4] = {}, rot[4] = {};
+            alignas(16) float sx[4] = {}, sy[4] = {}, sw[4] = {}, sh[4] = {};
+            for (size_t l = 0; l < lanes; l++)
+            {
+                const SpriteInstance& sprite = sprites[base + l];
+                px[l]  = sprite.pos.x;       py[l] = sprite.pos.y;
+                w[l]   = sprite.size.x;      h[l]  = sprite.size.y;
+                rot[l] = sprite.rotation;
+                sx[l]  = sprite.srcrect.x;   sy[l] = sprite.srcrect.y;
+                sw[l]  = sprite.srcrect.width; sh[l] = sprite.srcrect.height;
+            }
+
+            const Float4 x = Float4::load(px), y = Float4::load(py);
+            const Float4 hw = Float4::load(w) * half, hh = Float4::load(h) * half;
+            Float4 sinr, cosr;
+            sincos(Float4::load(rot), sinr, cosr);
+
+            int visible = (1 << lanes) - 1;
+            if (doCull)
+            {
+                // Half extents of the rotated sprite's AABB
+                const Float4 ahw = max(hw, zero - hw), ahh = max(hh, zero - hh);
+                const Float4 as  = max(sinr, zero - sinr), ac = max(cosr, zero - cosr);
+                const Float4 ex  = ahw * ac + ahh * as;
+                const Float4 ey  = ahw * as + ahh * ac;
+                visible &= bits((x + ex >= viewLeft) & (x - ex <= viewRight) &
+                                (y + ey >= viewTop)  & (y - ey <= viewBottom));
+            }
+            if (!visible) { continue; }
+
+            // Same uv inset as getTextureUVs()
+            const Float4 invW = Float4::set1(invTexSize.x), invH = Float4::set1(invTexSize.y);
+            const Float4 srcX = Float4::load(sx), srcY = Float4::load(sy);
+            alignas(16) float u0[4], v0[4], u1[4], v1[4];
+            ((srcX + Float4::set1(0.02f)) * invW).store(u0);
+            ((srcY + Float4::set1(0.02f)) * invH).store(v0);
+            ((srcX + Float4::load(sw) - Float4::set1(0.01f)) * invW).store(u1);
+            ((srcY + Float4::load(sh) - Float4::set1(0.01f)) * invH).store(v1);
+
+            if (instanced)
+            {
+                alignas(16) float s[4], c[4];
+                sinr.store(s); cosr.store(c);
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    if (!(visible & (1 << l))) { continue; }
+                    if (!uvsInUnitRange({ { u0[l], v0[l] }, { u1[l], v1[l] } })) { wrapped.push_back(uint32_t(base + l)); continue; }
+                    const SpriteInstance& sprite = sprites[base + l];
+                    SpriteInstanceData& inst = list.instances.emplace_back();
+                    inst.pos      = sprite.pos - sprite.size / 2.f;
+                    inst.size     = sprite.size;
+                    inst.origin   = sprite.size / 2.f;
+                    inst.rotation = sprite.rotation;
+                    inst.uv[0]    = toUnorm16(u0[l]);
+                    inst.uv[1]    = toUnorm16(v0[l]);
+                    inst.uv[2]    = toUnorm16(u1[l]);
+                    inst.uv[3]    = toUnorm16(v1[l]);
+                    inst.color    = sprite.color.toRGBAi();
+                    ++written;
+                }
+                continue;
+            }
+
+            // Corners relative to the center, rotated: (dx * cos - dy * sin, dx * sin + dy * cos)
+            const Float4 hwc = hw * cosr, hws = hw * sinr;
+            const Float4 hhc = hh * cosr, hhs = hh * sinr;
+            alignas(16) float cx[4][4], cy[4][4];
+            (x - hwc + hhs).store(cx[0]); (y - hws - hhc).store(cy[0]); // top left
+            (x + hwc + hhs).store(cx[1]); (y + hws - hhc).store(cy[1]); // top right
+            (x - hwc - hhs).store(cx[2]); (y - hws + hhc).store(cy[2]); // bottom left
+            (x + hwc - hhs).store(cx[3]); (y + hws + hhc).store(cy[3]); // bottom right
+
+            for (size_t l = 0; l < lanes; l++)
+            {
+                if (!(visible & (1 << l))) { continue; }
+                if (!uvsInUnitRange({ { u0[l], v0[l] }, { u1[l], v1[l] } })) { wrapped.push_back(uint32_t(base + l)); continue; }
+                const ColorRGBAi color = sprites[base + l].color.toRGBAi();
+                const uint32_t   first = written * 4;
+                list.vertices.push_back(makeVert(cx[0][l], cy[0][l], u0[l], v0[l], color));
+                list.vertices.push_back(makeVert(cx[1][l], cy[1][l], u1[l], v0[l], color));
+                list.vertices.push_back(makeVert(cx[2][l], cy[2][l], u0[l], v1[l], color));
+                list.vertices.push_back(makeVert(cx[3][l], cy[3][l], u1[l], v1[l], color));
+                for (const uint32_t i : sprite_indices) { list.indices.push_back(first + i); }
+                ++written;
+            }
+        }
+
+        if (written == 0) { list.drawCmds.pop_back(); }
+        else
+        {
+            cmd.posSize = instanced ? written : written * 4;
+            cmd.indSize = instanced ? 0       : written * 6;
+        }
+
+        // Each in its own command, after the rest. They were culled already.
+        for (const uint32_t i : wrapped)
+        {
+            const SpriteInstance& sprite = sprites[i];
+            sprite_batch(texture, sprite.srcrect, Rectf(sprite.pos - sprite.size / 2.f, sprite.size), sprite.rotation,
+                         sprite.color, layer, OriginCenter, false, false, shader, false);
+        }
+    }
+
+    // drawNinePatchTex() and drawNinePatches() implementation, one command for all of the panels
+    static void ninepatch_batch(      Texture&                   texture,
+                                const std::span<const NinePatch> panels,
+                                const int                        layer,
+                                const bool                       cull)
+    {
+        ASSERT(inited); // Forgot to call Renderer2D::init()
+        CommandList& list = target();
+        if (panels.empty()) { return; }
+
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture  = &texture;
+        cmd.layer    = layer;
+        cmd.drawMode = GLDrawMode::Triangles;
+        cmd.key      = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex = list.vertices.size();
+        cmd.indIndex = list.indices.size();
+
+        const Vector2f invTexSize = Vector2f(1.f, 1.f) / Vector2f(texture.getSize());
+
+        uint32_t written = 0;
+        for (const NinePatch& panel : panels)
+        {
+            const Rectf& src = panel.srcRect;
+            const Rectf& dst = panel.dstRect;
+            if (culled(dst, cull)) { continue; }
+
+            // Borders shrink to fit panels that are smaller than them
+            const float fitX = std::clamp(dst.width  / std::max(panel.left + panel.right,  1e-6f), 0.f, 1.f);
+            const float fitY = std::clamp(dst.height / std::max(panel.top  + panel.bottom, 1e-6f), 0.f, 1.f);
+
+            const float xs[4] = { dst.x, dst.x + panel.left * fitX, dst.getRight()  - panel.right  * fitX, dst.getRight()  };
+            const float ys[4] = { dst.y, dst.y + panel.top  * fitY, dst.getBottom() - panel.bottom * fitY, dst.getBottom() };
+
+            // Outer edges get the same inset as getTextureUVs(), inner edges are shared by neighbouring slices
+            const float us[4] = { (src.x + 0.02f)                  * invTexSize.x,
+                                  (src.x + panel.left)             * invTexSize.x,
+                                  (src.getRight() - panel.right)   * invTexSize.x,
+                                  (src.getRight() - 0.01f)         * invTexSize.x };
+            const float vs[4] = { (src.y + 0.02f)                  * invTexSize.y,
+                                  (src.y + panel.top)              * invTexSize.y,
+                                  (src.getBottom() - panel.bottom) * invTexSize.y,
+                                  (src.getBottom() - 0.01f)        * invTexSize.y };
+
+            const ColorRGBAi color = panel.color.toRGBAi();
+            for (int y = 0; y < 4; y++)
+            {
+                for (int x = 0; x < 4; x++)
+                { list.vertices.push_back(makeVert(xs[x], ys[y], us[x], vs[y], color)); }
+            }
+
+            const uint32_t first = written * 16;
+            for (const uint32_t i : ninepatch_indices) { list.indices.push_back(first + i); }
+            ++written;
+        }
+
+        if (written == 0)
+        {
+            list.drawCmds.pop_back();
+            return;
+        }
+
+        cmd.posSize = written * 16;
+        cmd.indSize = written * static_cast<uint32_t>(ninepatch_indices.size());
+    }
+
+    // Every primitive becomes an indexed triangle list drawn with whiteTex and defaultShader,
+    // so they end up in the same batches as sprites.
     static void prim_batch(const std::span<const Vector2f>&  points,
                            const ColorRGBAf&                 color = ColorRGBAf::white(),
                            const GLDrawMode                  mode  = GLDrawMode::LineStrip,
-                           const int                         layer = DefaultPrimitiveLayer)
+                           const int                         layer = DefaultPrimitiveLayer,
+                           const bool                        cull  = true)
     {
         ASSERT(inited); // Forgot to call Renderer2D::init()
+        CommandList& list = target();
         ASSERT(points.size() > 0);
 
-        drawCmds.emplace_back();
-        DrawCmd& cmd = drawCmds.back();
-        
+        const bool stroked = mode == GLDrawMode::LineStrip || mode == GLDrawMode::LineLoop ||
+                             mode == GLDrawMode::Lines     || mode == GLDrawMode::Points;
+
+        if (cull && cullingEnabled)
+        {
+            Vector2f min = points[0];
+            Vector2f max = points[0];
+            for (const Vector2f& p : points)
+            {
+                min.x = std::min(min.x, p.x); min.y = std::min(min.y, p.y);
+                max.x = std::max(max.x, p.x); max.y = std::max(max.y, p.y);
+            }
+
+            // Miters can stick out further, but never past miterLimit
+            const float pad = stroked ? lineWidth * 0.5f * miterLimit : 0.f;
+            min -= Vector2f(pad, pad);
+            max += Vector2f(pad, pad);
+            if (!isVisible(Rectf(min, max - min))) { return; }
+        }
+
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
         cmd.texture  = &whiteTex;
         cmd.layer    = layer;
-        cmd.drawMode = mode;
-        cmd.color    = color;
+        cmd.drawMode = GLDrawMode::Triangles;
+        cmd.key      = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.indIndex = list.indices.size();
+        cmd.posIndex = list.vertices.size();
 
-        cmd.indIndex = indices.size();
-        cmd.indSize  = points.size();
-        cmd.posIndex = posAndCoords.size();
-        cmd.posSize  = cmd.indSize;
-        
-        for (int i = 0; i < cmd.indSize; i++)
+        const ColorRGBAi packedColor = color.toRGBAi();
+        if (stroked)
+        { stroke_batch(list, points, mode, packedColor, cmd.posIndex); }
+        else
         {
-            const Vector2f& p = points[i];
-            posAndCoords.emplace_back(p.x, p.y, 0.f, 0.f);
-            indices.push_back(i);
+            const uint32_t count = points.size();
+            for (const Vector2f& p : points)
+            { list.vertices.push_back(makeVert(p.x, p.y, 0.f, 0.f, packedColor)); }
+
+            switch (mode)
+            {
+            case GLDrawMode::TriangleFan:
+                for (uint32_t i = 1; i + 1 < count; i++)
+                { list.indices.insert(list.indices.end(), { 0, i, i + 1 }); }
+                break;
+
+            case GLDrawMode::TriangleStrip:
+                for (uint32_t i = 0; i + 2 < count; i++)
+                { list.indices.insert(list.indices.end(), { i, i + 1, i + 2 }); }
+                break;
+
+            case GLDrawMode::Triangles:
+                for (uint32_t i = 0; i < count - count % 3; i++)
+                { list.indices.push_back(i); }
+                break;
+
+            default:
+                ASSERTMSG(false, "Renderer2D can't draw primitives with this draw mode");
+                break;
+            }
+        }
+
+        cmd.posSize = list.vertices.size() - cmd.posIndex;
+        cmd.indSize = list.indices.size()  - cmd.indIndex;
+
+        // Not enough points for a single triangle
+        if (cmd.indSize == 0)
+        {
+            list.vertices.resize(cmd.posIndex);
+            list.drawCmds.pop_back();
+        }
+    }
+
+    // Appends the triangles of lines lineWidth wide through points, with indices relative to firstVertex.
+    // Each segment is a quad, joins fill the wedge on the outside of the turn between two segments.
+    static void stroke_batch(      CommandList&               list,
+                             const std::span<const Vector2f>& points,
+                             const GLDrawMode                 mode,
+                             const ColorRGBAi&                color,
+                             const uint32_t                   firstVertex)
+    {
+        const float  halfWidth = lineWidth * 0.5f;
+        const size_t count     = points.size();
+
+        auto vert = [&](const Vector2f& p) -> uint32_t
+        {
+            list.vertices.push_back(makeVert(p.x, p.y, 0.f, 0.f, color));
+            return static_cast<uint32_t>(list.vertices.size() - 1 - firstVertex);
+        };
+
+        auto tri = [&](uint32_t a, uint32_t b, uint32_t c)
+        { list.indices.insert(list.indices.end(), { a, b, c }); };
+
+        // Left hand unit normal of a -> b, zero if the points are the same
+        auto normal = [](const Vector2f& a, const Vector2f& b) -> Vector2f
+        {
+            const Vector2f d   = b - a;
+            const float    len = d.length();
+            return len > 1e-6f ? Vector2f(-d.y / len, d.x / len) : Vector2f(0.f, 0.f);
+        };
+
+        auto segment = [&](const Vector2f& a, const Vector2f& b, const Vector2f& n)
+        {
+            const Vector2f offset = n * halfWidth;
+            const uint32_t first  = vert(a + offset);
+            vert(a - offset);
+            vert(b + offset);
+            vert(b - offset);
+            tri(first, first + 1, first + 2);
+            tri(first + 2, first + 1, first + 3);
+        };
+
+        // n0 and n1 are the normals of the segments before and after p
+        auto join = [&](const Vector2f& p, Vector2f n0, Vector2f n1)
+        {
+            if (lineJoin == Renderer2DLineJoin::None) { return; }
+
+            const float cross = n0.cross(n1);
+            if (std::abs(cross) < 1e-4f) { return; } // Straight on, or a zero length segment
+
+            // Turning towards the normals, the outside is on the other side
+            if (cross > 0.f)
+            {
+                n0 = n0 * -1.f;
+                n1 = n1 * -1.f;
+            }
+
+            const uint32_t center = vert(p);
+            const uint32_t first  = vert(p + n0 * halfWidth);
+
+            if (lineJoin == Renderer2DLineJoin::Round)
+            {
+                const float angle = std::atan2(cross, n0.dot(n1));
+                const int   steps = std::max(1, static_cast<int>(std::ceil(std::abs(angle) / roundJoinStep)));
+                uint32_t prev = first;
+                for (int i = 1; i < steps; i++)
+                {
+                    const uint32_t next = vert(p + n0.rotated(angle * i / steps) * halfWidth);
+                    tri(center, prev, next);
+                    prev = next;
+                }
+                tri(center, prev, vert(p + n1 * halfWidth));
+                return;
+            }
+
+            const uint32_t last = vert(p + n1 * halfWidth);
+
+            // cos of half the angle between the normals, 1 / cosHalf is the miter length / line width
+            const Vector2f miter   = (n0 + n1).normalized();
+            const float    cosHalf = miter.dot(n0);
+            if (lineJoin == Renderer2DLineJoin::Miter && cosHalf * miterLimit >= 1.f)
+            {
+                const uint32_t tip = vert(p + miter * (halfWidth / cosHalf));
+                tri(center, first, tip);
+                tri(center, tip, last);
+            }
+            else
+            { tri(center, first, last); }
+        };
+
+        switch (mode)
+        {
+        case GLDrawMode::Points:
+            for (const Vector2f& p : points)
+            { segment(p - Vector2f(halfWidth, 0.f), p + Vector2f(halfWidth, 0.f), Vector2f(0.f, 1.f)); }
+            break;
+
+        case GLDrawMode::Lines:
+            for (size_t i = 0; i + 1 < count; i += 2)
+            { segment(points[i], points[i + 1], normal(points[i], points[i + 1])); }
+            break;
+
+        case GLDrawMode::LineStrip:
+        case GLDrawMode::LineLoop:
+        {
+            const bool   loop     = mode == GLDrawMode::LineLoop && count > 2;
+            const size_t segments = loop ? count : count - 1;
+
+            Vector2f firstNormal, prevNormal;
+            for (size_t i = 0; i < segments; i++)
+            {
+                const Vector2f& a = points[i];
+                const Vector2f& b = points[(i + 1) % count];
+                const Vector2f  n = normal(a, b);
+                segment(a, b, n);
+
+                if (i == 0) { firstNormal = n;               }
+                else        { join(a, prevNormal, n);        }
+                prevNormal = n;
+            }
+
+            if (loop) { join(points[0], prevNormal, firstNormal); }
+            break;
+        }
+
+        default:
+            break;
         }
     }
 
-    static void text_batch(const String&     text,
+    static uint64_t glyphRunHash(std::string_view text, const Font& font, uint64_t generation, float scale, bool instanced)
+    {
+        uint64_t hash = Hash<std::string_view>()(text);
+        auto mix = [&](uint64_t v) { hash ^= v + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2); };
+        mix(reinterpret_cast<uintptr_t>(&font));
+        mix(generation);
+        mix(std::bit_cast<uint32_t>(scale));
+        mix(instanced);
+        return hash;
+    }
+
+    // Lays text out into run, one quad per glyph in the same place sprite_batch() put them when it drew each glyph.
+    // Glyphs loaded into other pages of the font as they're drawn are grouped by page, in the order they're in the text.
+    static void buildGlyphRun(GlyphRun& run, std::string_view text, Font& font, float scale, bool instanced)
+    {
+        run.pages    .clear();
+        run.vertices .clear();
+        run.indices  .clear();
+        run.instances.clear();
+
+        Vector<GlyphQuad>& quads = glyphRuns.quads;
+        quads.clear();
+
+        Vector2f lo(FLT_MAX, FLT_MAX), hi(-FLT_MAX, -FLT_MAX);
+        bool     sorted = true;
+        font.layoutText(text, scale, [&](const FontAtlasChar& ch, const Vector2f& pen)
+        {
+            const Rectf dst(pen.x + float(ch.bearing.x) * scale,
+                            pen.y - float(ch.rect.height - ch.bearing.y) * scale,
+                            float(ch.rect.width)  * scale,
+                            float(ch.rect.height) * scale);
+            if (dst.width <= 0.f || dst.height <= 0.f) { return; } // Spaces
+
+            lo = Vector2f(std::min(lo.x, dst.x), std::min(lo.y, dst.y));
+            hi = Vector2f(std::max(hi.x, dst.getRight()), std::max(hi.y, dst.getBottom()));
+
+            sorted = sorted && (quads.empty() || quads.back().page <= ch.page);
+            quads.push_back(GlyphQuad{ dst, Rectf(ch.rect), ch.page });
+        });
+
+        run.bounds = lo.x <= hi.x ? Rectf(lo, hi - lo) : Rectf();
+
+        // Usually everything is in the preloaded page
+        if (!sorted)
+        {
+            std::stable_sort(quads.begin(), quads.end(),
+                [](const GlyphQuad& a, const GlyphQuad& b) { return a.page < b.page; });
+        }
+
+        const ColorRGBAi color = ColorRGBAi(255, 255, 255, 255);
+        for (const GlyphQuad& quad : quads)
+        {
+            if (run.pages.empty() || run.pages.back().page != quad.page)
+            {
+                const uint32_t first = instanced ? run.instances.size() : run.vertices.size();
+                run.pages.push_back(GlyphRunPage{ quad.page, first, 0, uint32_t(run.indices.size()), 0 });
+            }
+            GlyphRunPage& page = run.pages.back();
+
+            const Rectf& dst = quad.dst;
+            const auto   uv  = getTextureUVs(font.getPage(quad.page), quad.src);
+            if (instanced)
+            {
+                SpriteInstanceData& inst = run.instances.emplace_back();
+                inst.pos      = Vector2f(dst.x, dst.y);
+                inst.size     = Vector2f(dst.width, dst.height);
+                inst.origin   = Vector2f(0.f, 0.f);
+                inst.rotation = 0.f;
+                inst.uv[0]    = toUnorm16(uv.first.x);
+                inst.uv[1]    = toUnorm16(uv.first.y);
+                inst.uv[2]    = toUnorm16(uv.second.x);
+                inst.uv[3]    = toUnorm16(uv.second.y);
+                inst.color    = color;
+                ++page.count;
+                continue;
+            }
+
+            const uint32_t first = page.count;
+            run.vertices.push_back(makeVert(dst.x,          dst.y,           uv.first.x,  uv.first.y,  color));
+            run.vertices.push_back(makeVert(dst.getRight(), dst.y,           uv.second.x, uv.first.y,  color));
+            run.vertices.push_back(makeVert(dst.x,          dst.getBottom(), uv.first.x,  uv.second.y, color));
+            run.vertices.push_back(makeVert(dst.getRight(), dst.getBottom(), uv.second.x, uv.second.y, color));
+            for (const uint32_t i : sprite_indices) { run.indices.push_back(first + i); }
+            page.count    += 4;
+            page.indCount += sprite_indices.size();
+        }
+    }
+
+    // The caches are thread_local, so disabling them can't reach the other threads' and each thread clears its own here
+    static void clearStaleGlyphRuns(GlyphRunCache& cache)
+    {
+        const uint32_t clears = glyphRunClears.load(std::memory_order_relaxed);
+        if (cache.clears != clears)
+        {
+            cache.runs.clear();
+            cache.clears = clears;
+        }
+    }
+
+    // The laid out quads of text, from the cache when it was drawn recently
+    static const GlyphRun& findGlyphRun(std::string_view text, Font& font, float scale, bool instanced)
+    {
+        GlyphRunCache& cache = glyphRuns;
+        clearStaleGlyphRuns(cache);
+        if (!glyphRunCacheEnabled.load(std::memory_order_relaxed))
+        {
+            buildGlyphRun(cache.scratch, text, font, scale, instanced);
+            return cache.scratch;
+        }
+
+        const uint64_t frame      = Renderer::getFrameIndex();
+        const uint64_t generation = font.glyphGeneration();
+        if (frame - cache.lastSweep >= glyphRunFrames)
+        {
+            cache.lastSweep = frame;
+            for (auto it = cache.runs.begin(); it != cache.runs.end();)
+            {
+                if (frame - it->second.lastUsed > glyphRunFrames) { it = cache.runs.erase(it); }
+                else                                              { ++it; }
+            }
+        }
+
+        GlyphRun& run = cache.runs[glyphRunHash(text, font, generation, scale, instanced)];
+        run.lastUsed  = frame;
+        if (run.font == &font && run.generation == generation && run.scale == scale && run.instanced == instanced && run.text == text)
+        {
+            // Keeps the glyphs' pages from being cleared while they're queued
+            for (const GlyphRunPage& page : run.pages) { font.touchPage(page.page); }
+
+            // stats is only touched by the main thread, it's added in by flush()
+            if (!activeList) { ++cachedTextCount; }
+            return run;
+        }
+
+        // New, or a hash collision which the latest string takes over
+        run.text.assign(text.data(), text.size());
+        run.font      = &font;
+        run.scale     = scale;
+        run.instanced = instanced;
+        buildGlyphRun(run, text, font, scale, instanced);
+
+        // Loading the glyphs can clear a page, then the run is found under the new generation next time
+        run.generation = font.glyphGeneration();
+        return run;
+    }
+
+    // drawText() implementation, one command for the whole string, or per font page it uses.
+    // pos is on the baseline of the first line, the layout is Font::layoutText()'s.
+    static void text_batch(std::string_view  text,
                                  Font&       font,
                            const Vector2f&   pos,
                            const int         layer = DefaultTextLayer,
                            const ColorRGBAf& color = ColorRGBAf::white(),
-                           const float       scale = 1.f)
+                           const float       scale = 1.f,
+                           const bool        cull  = true)
     {
         ASSERT(inited); // Forgot to call Renderer2D::init()
         ASSERT(font.getAtlas().created());
 
-        if (!font.created()) { return; }
+        if (!font.created() || text.empty()) { return; }
 
-        Vector2f currentPos = pos;
-        WideString wide = toWide(text);
-        for (auto& strchar : wide)
+        const bool      instanced = instancingEnabled;
+        const GlyphRun& run       = findGlyphRun(text, font, scale, instanced);
+        if (run.pages.empty()) { return; }
+        if (culled(Rectf(run.bounds.getPos() + pos, run.bounds.getSize()), cull)) { return; }
+
+        CommandList&     list        = target();
+        const ColorRGBAi packedColor = color.toRGBAi();
+        for (const GlyphRunPage& page : run.pages)
         {
-            if (strchar == '\n')
+            if (recording && page.page != 0)
+            {
+                const Pair<Font*, uint32_t> used(&font, page.page);
+                if (std::find(recordedFontPages.begin(), recordedFontPages.end(), used) == recordedFontPages.end())
+                { recordedFontPages.push_back(used); }
+            }
+
+            list.drawCmds.emplace_back();
+            DrawCmd& cmd = list.drawCmds.back();
+
+            cmd.texture   = &font.getPage(page.page);
+            cmd.shader    = instanced ? &instanceTextShader : &textShader;
+            cmd.layer     = layer;
+            cmd.drawMode  = instanced ? GLDrawMode::TriangleStrip : GLDrawMode::Triangles;
+            cmd.instanced = instanced;
+            cmd.key       = makeSortKey(cmd, list.drawCmds.size() - 1);
+
+            // Copied as they are, then moved to pos and tinted
+            if (instanced)
             {
-                currentPos.y += font.lineSpacing();
-                currentPos.x = pos.x;
+                cmd.posIndex = list.instances.size();
+                cmd.posSize  = page.count;
+                cmd.indIndex = 0;
+                cmd.indSize  = 0;
+                const auto src = run.instances.begin() + page.first;
+                list.instances.insert(list.instances.end(), src, src + page.count);
+                for (SpriteInstanceData& inst : std::span(list.instances.data() + cmd.posIndex, cmd.posSize))
+                {
+                    inst.pos   += pos;
+                    inst.color  = packedColor;
+                }
                 continue;
             }
 
-            FontAtlasChar* ch;
-            if (!font.containsChar(strchar))
-            { ch = &font.getFallbackChar(); }
-            else
-            { ch = &font.getChar(strchar); }
+            cmd.posIndex = list.vertices.size();
+            cmd.posSize  = page.count;
+            cmd.indIndex = list.indices.size();
+            cmd.indSize  = page.indCount;
+            const auto vertSrc = run.vertices.begin() + page.first;
+            const auto indSrc  = run.indices .begin() + page.indFirst;
+            list.vertices.insert(list.vertices.end(), vertSrc, vertSrc + page.count);
+            list.indices .insert(list.indices.end(),  indSrc,  indSrc  + page.indCount);
+            for (PrimVert& vert : std::span(list.vertices.data() + cmd.posIndex, cmd.posSize))
+            {
+                vert.pos   += pos;
+                vert.color  = packedColor;
+            }
+        }
+    }
+
+    static uint64_t polygonHash(std::span<const Vector2f> points, std::span<const uint32_t> holeStarts)
+    {
+        uint64_t hash = Hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(points.data()), points.size_bytes()));
+        auto mix = [&](uint64_t v) { hash ^= v + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2); };
+        for (const uint32_t start : holeStarts) { mix(start); }
+        return hash;
+    }
+
+    // Turns the same way at every corner and goes around once, so a triangle fan covers it.
+    // Collinear corners don't count, self intersecting outlines like stars wind around more than once.
+    static bool isConvex(std::span<const Vector2f> points)
+    {
+        const size_t n = points.size();
+        if (n < 3) { return false; }
+
+        float turn   = 0.f;
+        float firstX = 0.f;
+        float lastX  = 0.f;
+        int   flips  = 0; // Times the outline turns back along x
+        for (size_t i = 0; i < n; i++)
+        {
+            const Vector2f ab = points[(i + 1) % n] - points[i];
+            const Vector2f bc = points[(i + 2) % n] - points[(i + 1) % n];
+
+            const float cross = ab.x * bc.y - ab.y * bc.x;
+            if (cross != 0.f)
+            {
+                if (turn != 0.f && (cross > 0.f) != (turn > 0.f)) { return false; }
+                turn = cross;
+            }
+
+            if (ab.x == 0.f) { continue; }
+            if (lastX != 0.f && (ab.x > 0.f) != (lastX > 0.f)) { ++flips; }
+            if (firstX == 0.f) { firstX = ab.x; }
+            lastX = ab.x;
+        }
+        if ((firstX > 0.f) != (lastX > 0.f)) { ++flips; }
+        return turn != 0.f && flips <= 2;
+    }
+
+    static void buildPolygonMesh(PolygonMesh& mesh, std::span<const Vector2f> points, std::span<const uint32_t> holeStarts)
+    {
+        mesh.points    .assign(points.begin(),     points.end());
+        mesh.holeStarts.assign(holeStarts.begin(), holeStarts.end());
+        mesh.indices.clear();
+        mesh.bounds = Rectf();
+        mesh.radius = 0.f;
+        if (points.empty()) { return; }
+
+        polygonMeshes.tessellator.triangulate(points, holeStarts, mesh.indices);
+
+        Vector2f min = points[0];
+        Vector2f max = points[0];
+        for (const Vector2f& p : points)
+        {
+            min.x = std::min(min.x, p.x); min.y = std::min(min.y, p.y);
+            max.x = std::max(max.x, p.x); max.y = std::max(max.y, p.y);
+            mesh.radius = std::max(mesh.radius, p.length());
+        }
+        mesh.bounds = Rectf(min, max - min);
+    }
+
+    // See clearStaleGlyphRuns()
+    static void clearStalePolygonMeshes(PolygonCache& cache)
+    {
+        const uint32_t clears = polygonMeshClears.load(std::memory_order_relaxed);
+        if (cache.clears != clears)
+        {
+            cache.meshes.clear();
+            cache.clears = clears;
+        }
+    }
 
-            const float originYOffset = ch->rect.height - ch->bearing.y;
+    // The tessellated polygon, from the cache when it was drawn recently
+    static const PolygonMesh& findPolygonMesh(std::span<const Vector2f> points, std::span<const uint32_t> holeStarts)
+    {
+        PolygonCache& cache = polygonMeshes;
+        clearStalePolygonMeshes(cache);
+        if (!polygonCacheEnabled.load(std::memory_order_relaxed))
+        {
+            buildPolygonMesh(cache.scratch, points, holeStarts);
+            return cache.scratch;
+        }
+
+        const uint64_t frame = Renderer::getFrameIndex();
+        if (frame - cache.lastSweep >= polygonMeshFrames)
+        {
+            cache.lastSweep = frame;
+            for (auto it = cache.meshes.begin(); it != cache.meshes.end();)
+            {
+                if (frame - it->second.lastUsed > polygonMeshFrames) { it = cache.meshes.erase(it); }
+                else                                                 { ++it; }
+            }
+        }
+
+        PolygonMesh& mesh = cache.meshes[polygonHash(points, holeStarts)];
+        mesh.lastUsed     = frame;
+        if (std::equal(mesh.points.begin(),     mesh.points.end(),     points.begin(),     points.end()) &&
+            std::equal(mesh.holeStarts.begin(), mesh.holeStarts.end(), holeStarts.begin(), holeStarts.end()) &&
+            !mesh.points.empty())
+        {
+            // stats is only touched by the main thread, it's added in by flush()
+            if (!activeList) { ++cachedShapeCount; }
+            return mesh;
+        }
+
+        // New, or a hash collision which the latest shape takes over
+        buildPolygonMesh(mesh, points, holeStarts);
+        return mesh;
+    }
+
+    // drawPolygon() and drawFilledPolygon() implementation, the mesh's triangles moved to pos and rotated around it
+    static void polygon_batch(const PolygonMesh& mesh,
+                              const Vector2f&    pos,
+                              const float        rotation,
+                              const ColorRGBAf&  color,
+                              const int          layer,
+                              const bool         cull)
+    {
+        ASSERT(inited); // Forgot to call Renderer2D::init()
+        if (mesh.indices.empty()) { return; }
+
+        const Rectf bounds = rotation == 0.f ?
+            Rectf(mesh.bounds.getPos() + pos, mesh.bounds.getSize()) :
+            Rectf(pos.x - mesh.radius, pos.y - mesh.radius, mesh.radius * 2.f, mesh.radius * 2.f);
+        if (culled(bounds, cull)) { return; }
+
+        CommandList& list = target();
+        list.drawCmds.emplace_back();
+        DrawCmd& cmd = list.drawCmds.back();
+
+        cmd.texture  = &whiteTex;
+        cmd.layer    = layer;
+        cmd.drawMode = GLDrawMode::Triangles;
+        cmd.key      = makeSortKey(cmd, list.drawCmds.size() - 1);
+        cmd.posIndex = list.vertices.size();
+        cmd.posSize  = mesh.points.size();
+        cmd.indIndex = list.indices.size();
+        cmd.indSize  = mesh.indices.size();
+
+        const ColorRGBAi packedColor = color.toRGBAi();
+        const float      c           = std::cos(rotation);
+        const float      s           = std::sin(rotation);
+        for (const Vector2f& p : mesh.points)
+        {
+            list.vertices.push_back(makeVert(pos.x + p.x * c - p.y * s,
+                                             pos.y + p.x * s + p.y * c, 0.f, 0.f, packedColor));
+        }
+        list.indices.insert(list.indices.end(), mesh.indices.begin(), mesh.indices.end());
+    }
+
+    static void circle_batch(const Vector2f&   pos,
+                             const float       rad,
+                             const bool        filled,
+                             const ColorRGBAf& color,
+                             const int         segmentCount,
+                             const int         layer,
+                             const bool        cull)
+    {
+        if (!recording)
+        {
+            const float outer = filled ? rad : rad + lineWidth * 0.5f;
+            shape_batch(pos, Vector2f(outer, outer), outer, filled ? 0.f : lineWidth, 0.f, color, layer, cull);
+            return;
+        }
+
+        // Cull before building the points, outlines stick out by half the line width
+        const float extent = filled ? rad : rad + lineWidth * 0.5f;
+        if (culled(Rectf(pos.x - extent, pos.y - extent, extent * 2.f, extent * 2.f), cull)) { return; }
 
-            float xpos = currentPos.x + ch->bearing.x * scale;
-            float ypos = currentPos.y - originYOffset * scale;
-            float w    = ch->rect.width  * scale;
-            float h    = ch->rect.height * scale;
-            currentPos.x += (ch->advance >> 6) * scale;
+        const float theta = 3.1415926f * 2.f / static_cast<float>(segmentCount);
+        const float tangetial_factor = tanf(theta);
+        const float radial_factor = cosf(theta);
+
+        float x = rad;
+        float y = 0;
 
-            sprite_batch(font.getAtlas(),
-                         Rectf(ch->rect),
-                         { xpos, ypos, w, h },
-                         0.0f,
-                         color,
-                         layer,
-                         OriginCenter,
-                         false,
-                         false,
-                         textShader);
+        auto& points = target().points;
+        points.clear();
+
+        for (int i = 0; i < segmentCount; i++)
+        {
+            points.push_back(Vector2f{ x + pos.x, y + pos.y });
+
+            float tx = -y;
+            float ty = x;
+            x += tx * tangetial_factor;
+            y += ty * tangetial_factor;
+            x *= radial_factor;
+            y *= radial_factor;
         }
+
+        prim_batch(points, color, filled ? GLDrawMode::TriangleFan : GLDrawMode::LineLoop, layer, false);
+    }
+
+    // Size of the render target draws go to, the window's framebuffer if none is bound
+    static Vector2f targetSize()
+    {
+        if (RenderTarget::getBoundRenderTarget())
+        { return Vector2f(RenderTarget::getBoundRenderTarget()->getSize()); }
+        return Vector2f(Renderer::getFramebufferSize());
+    }
+
+    // The view's width shrinks by its zoom, see View::getMatrix(), and spans its viewport of the target
+    // setView() without the check, for render(..., true) which draws what's queued with another view on purpose
+    static void applyView(const View& view)
+    {
+        currentView = view;
+        cullBounds  = view.getBounds();
+        updatePixelSize();
+    }
+
+    static void updatePixelSize()
+    {
+        const float pixels = float(getViewportSizePixels(currentView, targetSize()).width);
+        const float width  = std::abs(currentView.size.x / currentView.zoom.x);
+        pixelSize = pixels > 0.f && std::isfinite(width) ? width / pixels : 1.f;
     }
 
     static void onWindowResized()
     {
+        updatePixelSize();
+
         //GLint viewport[4];
         //glGetIntegerv(GL_VIEWPORT, viewport);
         //auto fbSize = Renderer::getFramebufferSize();
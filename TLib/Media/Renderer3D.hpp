@@ -113,6 +113,7 @@ public:
     static inline Vector<PrimVertex> primitiveVerts;
     static inline Vector<uint32_t>   primitiveIndices;
     static inline GPUVertexData      primitiveMesh;
+    static inline uint64_t           primitiveFrameIndex = UINT64_MAX; // Renderer::getFrameIndex() of the last upload
     static inline Shader             defaultPrimitiveShader;
 
     static inline Vector<DrawCmd> cmds;
@@ -410,6 +411,7 @@ public:
         // Setup Primitive Rendering
         {
             primitiveMesh.setLayout({ TLib::Layout::Vec3f(), TLib::Layout::Vec4f() });
+            primitiveMesh.setStreamCapacity(1024 * 16, 1024 * 16);
 
             defaultPrimitiveShader.create(
                 myEmbeds.at("TLib/Embed/Shaders/3d_primitive.vert").asString(),
@@ -774,6 +776,29 @@ private:
         return glm::lookAt(lookFrom.toGlm(), lookTo.toGlm(), up.toGlm());
     }
 
+    // Copies every primitive of the frame into the streaming mesh at once, cmd.posIndex and cmd.indIndex are relative to the range
+    static GPUVertexData::StreamRange<PrimVertex> uploadPrimitives()
+    {
+        GPUVertexData::StreamRange<PrimVertex> range;
+        if (primitiveVerts.empty()) { return range; }
+
+        const uint32_t frames = Renderer::getFramesInFlight();
+        if (primitiveMesh.streamFrameCount() != frames)
+        { primitiveMesh.setStreamFrameCount(frames); }
+
+        if (primitiveFrameIndex != Renderer::getFrameIndex())
+        {
+            primitiveFrameIndex = Renderer::getFrameIndex();
+            primitiveMesh.beginStreamFrame();
+        }
+
+        range = primitiveMesh.mapStream<PrimVertex>(primitiveVerts.size(), primitiveIndices.size());
+        std::copy(primitiveVerts.begin(),   primitiveVerts.end(),   range.vertices);
+        std::copy(primitiveIndices.begin(), primitiveIndices.end(), range.indices);
+        primitiveMesh.unmapStream();
+        return range;
+    }
+
     static void renderMeshes()
     {
         setCullMode(faceCullMode);
@@ -783,20 +808,18 @@ private:
 
         Renderer::setViewport(Recti(0, 0, Renderer::getFramebufferSize()));
 
+        const auto primitives = uploadPrimitives();
+
         for (auto& varCmd : cmds)
         {
             if (is<PrimitiveDrawCmd>(varCmd))
             {
                 PrimitiveDrawCmd& cmd = std::get<PrimitiveDrawCmd>(varCmd);
 
-                Span<PrimVertex> pos(primitiveVerts.begin()   + cmd.posIndex, cmd.posSize);
-                Span<uint32_t>   ind(primitiveIndices.begin() + cmd.indIndex, cmd.indSize);
-
-                primitiveMesh.setData   (pos, AccessType::Dynamic);
-                primitiveMesh.setIndices(ind, AccessType::Dynamic);
-
                 RenderState rs; rs.drawMode = cmd.drawMode;
-                Renderer::draw(*cmd.shader, primitiveMesh, rs);
+                Renderer::drawRange(*cmd.shader, primitiveMesh, cmd.indSize,
+                                    primitives.firstIndex + cmd.indIndex,
+                                    primitives.baseVertex + cmd.posIndex, rs);
             }
 
             else if (is<ModelDrawCmd>(varCmd))
@@ -816,6 +839,8 @@ private:
                 }
             }
         }
+
+        if (primitives.vertexCount > 0) { primitiveMesh.fenceStream(); }
     }
 
     static void uploadLights()
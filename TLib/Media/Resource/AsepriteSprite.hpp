@@ -0,0 +1,296 @@
+#pragma once
+
+#include <TLib/Media/Resource/Texture.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <TLib/NonAssignable.hpp>
+#include <TLib/String.hpp>
+#include <TLib/Files.hpp>
+#include <TLib/thirdparty/RectPack2D.hpp>
+#include <TLib/thirdparty/cute.hpp>
+#include <cstring>
+
+enum class AsepriteDirection
+{
+    Forwards,
+    Backwards,
+    PingPong,
+    PingPongReverse // Ping pong starting from the last frame, written by Aseprite 1.3
+};
+
+// A frame range of an AsepriteSprite, as tagged in Aseprite
+struct AsepriteTag
+{
+    String            name;
+    uint32_t          from      = 0; // First and last frame, inclusive
+    uint32_t          to        = 0;
+    AsepriteDirection direction = AsepriteDirection::Forwards;
+};
+
+/*
+An .ase/.aseprite file decoded with cute_aseprite.
+Every frame is packed into one atlas texture, so drawing any frame of any animation binds the same texture.
+
+    AsepriteSprite player;
+    player.loadFromFile("assets/player.ase");
+
+    // Every frame
+    const AsepriteTag* run = player.findTag("Run");
+    Renderer2D::drawTexture(player.getFrame(player.frameAt(*run, time)), pos);
+
+Frames with the same pixels share their spot in the atlas.
+*/
+struct AsepriteSprite : NonCopyable
+{
+protected:
+    struct Frame
+    {
+        SubTexture subTexture;
+        uint32_t   duration = 100; // Milliseconds
+    };
+
+    Texture             atlas;
+    Vector<Frame>       frames;
+    Vector<AsepriteTag> tags;
+    Vector2i            frameSize;
+    Path                _path;
+
+    // 1 texel of space around every frame, so filtering doesn't pick up the neighbours
+    static constexpr int padding = 1;
+
+    using SpacesType = rectpack2D::empty_spaces<false>;
+    using RectType   = rectpack2D::output_rect_t<SpacesType>;
+
+    // Frame shown t milliseconds into playing from..to once, in the given direction
+    uint32_t walk(uint32_t from, uint32_t to, bool backwards, uint32_t t) const
+    {
+        const uint32_t count = to - from + 1;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t frame = backwards ? to - i : from + i;
+            if (t < frames[frame].duration) { return frame; }
+            t -= frames[frame].duration;
+        }
+        return backwards ? from : to;
+    }
+
+    // The direction byte of a tag, cute_aseprite passes it through as it is in the file
+    AsepriteDirection toDirection(int direction, const String& tagName) const
+    {
+        switch (direction)
+        {
+        case 0: return AsepriteDirection::Forwards;
+        case 1: return AsepriteDirection::Backwards;
+        case 2: return AsepriteDirection::PingPong;
+        case 3: return AsepriteDirection::PingPongReverse;
+        default:
+            tlog::warn("AsepriteSprite: Tag '{}' of '{}' has an unknown direction ({}), playing it forwards",
+                       tagName, _path.string(), direction);
+            return AsepriteDirection::Forwards;
+        }
+    }
+
+    uint32_t rangeDuration(uint32_t from, uint32_t to) const
+    {
+        uint32_t total = 0;
+        for (uint32_t i = from; i <= to; i++) { total += frames[i].duration; }
+        return total;
+    }
+
+    bool load(ase_t* ase)
+    {
+        reset();
+        if (!ase)
+        {
+            tlog::error("AsepriteSprite: Failed to decode '{}'", _path.string());
+            return false;
+        }
+
+        // Tags are clamped to the frames, and frameAt() divides by their durations
+        if (ase->frame_count <= 0 || ase->w <= 0 || ase->h <= 0)
+        {
+            tlog::error("AsepriteSprite: '{}' has no frames", _path.string());
+            cute_aseprite_free(ase);
+            return false;
+        }
+
+        frameSize = { ase->w, ase->h };
+        const size_t frameBytes = size_t(ase->w) * ase->h * sizeof(ase_color_t);
+
+        // Identical frames, like held poses, are packed once. unique[i] is the frame whose pixels frame i uses.
+        Vector<uint32_t>      unique(ase->frame_count);
+        Vector<uint32_t>      rectOf(ase->frame_count);
+        std::vector<RectType> rects; // rectpack2D wants a std::vector
+        for (int i = 0; i < ase->frame_count; i++)
+        {
+            unique[i] = i;
+            for (int j = 0; j < i; j++)
+            {
+                if (unique[j] == uint32_t(j) && memcmp(ase->frames[i].pixels, ase->frames[j].pixels, frameBytes) == 0)
+                { unique[i] = j; break; }
+            }
+
+            if (unique[i] == uint32_t(i))
+            {
+                rectOf[i] = rects.size();
+                rects.push_back(RectType(0, 0, ase->w + padding * 2, ase->h + padding * 2));
+            }
+            else { rectOf[i] = rectOf[unique[i]]; }
+        }
+
+        const int  maxTexSize          = Renderer::getMaxTextureSize();
+        const int  discardStep         = -4;
+        auto       reportSuccessful    = [](RectType&) { return rectpack2D::callback_result::CONTINUE_PACKING; };
+        auto       reportUnsuccessful  = [](RectType&) { return rectpack2D::callback_result::ABORT_PACKING; };
+        const auto atlasSize = rectpack2D::find_best_packing<SpacesType>(rects,
+            rectpack2D::make_finder_input(maxTexSize, discardStep, reportSuccessful, reportUnsuccessful,
+                                          rectpack2D::flipping_option::DISABLED));
+
+        if (atlasSize.w > maxTexSize || atlasSize.h > maxTexSize)
+        {
+            tlog::error("AsepriteSprite: The frames of '{}' don't fit in one texture", _path.string());
+            cute_aseprite_free(ase);
+            return false;
+        }
+
+        // Aseprite rows go down, texture rows go up (images are flipped on load), so frames are copied upside down
+        Vector<ase_color_t> pixels(size_t(atlasSize.w) * atlasSize.h, ase_color_t{ 0, 0, 0, 0 });
+        for (int i = 0; i < ase->frame_count; i++)
+        {
+            if (unique[i] != uint32_t(i)) { continue; }
+
+            const RectType& rect = rects[rectOf[i]];
+            for (int row = 0; row < ase->h; row++)
+            {
+                const ase_color_t* src = ase->frames[i].pixels + size_t(row) * ase->w;
+                ase_color_t*       dst = pixels.data() + size_t(rect.y + padding + ase->h - 1 - row) * atlasSize.w + rect.x + padding;
+                memcpy(dst, src, size_t(ase->w) * sizeof(ase_color_t));
+            }
+        }
+
+        atlas.setData(pixels.data(), atlasSize.w, atlasSize.h, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
+        atlas.setFilter(TextureMinFilter::Nearest, TextureMagFilter::Nearest);
+
+        frames.resize(ase->frame_count);
+        for (int i = 0; i < ase->frame_count; i++)
+        {
+            const RectType& rect = rects[rectOf[i]];
+            frames[i].subTexture = SubTexture(atlas, Rectf(float(rect.x + padding), float(rect.y + padding),
+                                                           float(ase->w), float(ase->h)));
+            frames[i].duration   = uint32_t(std::max(1, ase->frames[i].duration_milliseconds));
+        }
+
+        for (int i = 0; i < ase->tag_count; i++)
+        {
+            const ase_tag_t& src = ase->tags[i];
+            AsepriteTag&     tag = tags.emplace_back();
+            tag.name      = src.name ? src.name : "";
+            tag.from      = uint32_t(std::clamp(src.from_frame, 0, ase->frame_count - 1));
+            tag.to        = uint32_t(std::clamp(src.to_frame,   int(tag.from), ase->frame_count - 1));
+            tag.direction = toDirection(int(src.loop_animation_direction), tag.name);
+        }
+
+        tlog::info("AsepriteSprite: Loaded '{}', {} frames ({} unique) in a {}x{} atlas, {} tags",
+                   _path.string(), frames.size(), rects.size(), atlasSize.w, atlasSize.h, tags.size());
+
+        cute_aseprite_free(ase);
+        return true;
+    }
+
+public:
+    AsepriteSprite()  = default;
+    ~AsepriteSprite() = default;
+
+    [[nodiscard]] inline bool     valid()      const { return !frames.empty(); }
+    [[nodiscard]] inline size_t   frameCount() const { return frames.size(); }
+    [[nodiscard]] inline Vector2i getSize()    const { return frameSize; } // Of every frame
+    [[nodiscard]] inline Path     path()       const { return _path; }
+
+    [[nodiscard]] inline Texture&                   getAtlas()       { return atlas; }
+    [[nodiscard]] inline const Vector<AsepriteTag>& getTags()  const { return tags;  }
+
+    bool loadFromFile(const Path& path)
+    {
+        _path = path;
+        return load(cute_aseprite_load_from_file(path.string().c_str(), nullptr));
+    }
+
+    bool loadFromMemory(const void* data, size_t size)
+    {
+        _path.clear();
+        return load(cute_aseprite_load_from_memory(data, int(size), nullptr));
+    }
+
+    void reset()
+    {
+        frames.clear();
+        tags  .clear();
+        atlas .reset();
+        frameSize = { 0, 0 };
+    }
+
+    [[nodiscard]] const SubTexture& getFrame(size_t frame) const
+    { return frames[frame].subTexture; }
+
+    // Milliseconds
+    [[nodiscard]] uint32_t getFrameDuration(size_t frame) const
+    { return frames[frame].duration; }
+
+    // nullptr if there's no tag called name
+    [[nodiscard]] const AsepriteTag* findTag(const String& name) const
+    {
+        for (const AsepriteTag& tag : tags)
+        { if (tag.name == name) { return &tag; } }
+        return nullptr;
+    }
+
+    // Milliseconds for one loop of the tag, ping pong tags go there and back
+    [[nodiscard]] uint32_t getTagDuration(const AsepriteTag& tag) const
+    {
+        const bool pingPong = tag.direction == AsepriteDirection::PingPong || tag.direction == AsepriteDirection::PingPongReverse;
+        uint32_t   total    = rangeDuration(tag.from, tag.to);
+        if (pingPong && tag.to - tag.from > 1)
+        { total += rangeDuration(tag.from + 1, tag.to - 1); }
+        return total;
+    }
+
+    // Frame of the tag shown seconds after it started playing, looping
+    [[nodiscard]] uint32_t frameAt(const AsepriteTag& tag, float seconds) const
+    {
+        ASSERT(valid());
+        if (frames.empty()) { return 0; }
+        const uint32_t duration = getTagDuration(tag);
+        if (duration == 0) { return tag.from; } // Only when the durations add up past UINT32_MAX
+        const uint32_t t = uint32_t(std::max(0.f, seconds) * 1000.f) % duration;
+
+        switch (tag.direction)
+        {
+        case AsepriteDirection::Forwards:  return walk(tag.from, tag.to, false, t);
+        case AsepriteDirection::Backwards: return walk(tag.from, tag.to, true,  t);
+        case AsepriteDirection::PingPong:
+        {
+            const uint32_t there = rangeDuration(tag.from, tag.to);
+            if (t < there || tag.to - tag.from < 2) { return walk(tag.from, tag.to, false, t); }
+            return walk(tag.from + 1, tag.to - 1, true, t - there);
+        }
+        case AsepriteDirection::PingPongReverse:
+        {
+            const uint32_t there = rangeDuration(tag.from, tag.to);
+            if (t < there || tag.to - tag.from < 2) { return walk(tag.from, tag.to, true, t); }
+            return walk(tag.from + 1, tag.to - 1, false, t - there);
+        }
+        }
+        return tag.from;
+    }
+
+    // Frame shown seconds after the whole sprite started playing, looping
+    [[nodiscard]] uint32_t frameAt(float seconds) const
+    {
+        ASSERT(valid());
+        if (frames.empty()) { return 0; }
+        const uint32_t duration = rangeDuration(0, frames.size() - 1);
+        if (duration == 0) { return 0; }
+        const uint32_t t = uint32_t(std::max(0.f, seconds) * 1000.f) % duration;
+        return walk(0, frames.size() - 1, false, t);
+    }
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <TLib/Types/Types.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <TLib/NonAssignable.hpp>
+#include <TLib/Logging.hpp>
+#include <TLib/String.hpp>
+#include <TLib/Files.hpp>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+/*
+A packed atlas saved to one file, so it can be loaded with one read and one texture upload instead of
+decoding and packing every image again. The file is laid out so it's used as it is once read:
+
+    Header | Entry[entryCount], sorted by nameHash | names | RGBA pixels, rows from the bottom like Texture
+
+Each entry remembers the size and write time of the file it was built from, see isUpToDate().
+TextureStitcherOffline::stitch() builds and reads these.
+*/
+struct AtlasCache : NonCopyable
+{
+    static constexpr uint32_t magic   = 0x43414C54; // "TLAC"
+    static constexpr uint32_t version = 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t namesSize;  // Bytes, padded to 8
+        int32_t  width;
+        int32_t  height;
+    };
+
+    struct Entry
+    {
+        uint64_t nameHash;
+        int64_t  sourceTime; // Write time of the source image, in file clock ticks
+        uint64_t sourceSize; // Bytes
+        int32_t  x, y, w, h; // Pixels in the atlas
+        uint32_t nameOffset; // Into the names
+        uint32_t nameSize;
+    };
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(Entry) % 8 == 0);
+
+    // What write() needs to know about each image
+    struct Source
+    {
+        String name;
+        Path   path;
+        Recti  rect;
+    };
+
+protected:
+    Vector<char>   file;
+    const Header*  header  = nullptr;
+    const Entry*   entries = nullptr;
+    const char*    names   = nullptr;
+    const uint8_t* pixels  = nullptr;
+
+    // FNV-1a, stable across builds unlike std::hash
+    static uint64_t hashName(std::string_view name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : name) { hash = (hash ^ uint8_t(c)) * 1099511628211ull; }
+        return hash;
+    }
+
+    static bool stamp(const Path& source, int64_t& time, uint64_t& size)
+    {
+        std::error_code err;
+        const auto writeTime = fs::last_write_time(source, err);
+        if (err) { return false; }
+        size = fs::file_size(source, err);
+        if (err) { return false; }
+        time = int64_t(writeTime.time_since_epoch().count());
+        return true;
+    }
+
+    static size_t padded(size_t size)
+    { return (size + 7) & ~size_t(7); }
+
+    // The name has to be inside the names and the rect inside the atlas, a damaged file would read past them otherwise
+    static bool entryInBounds(const Entry& entry, const Header& head)
+    {
+        return uint64_t(entry.nameOffset) + entry.nameSize <= head.namesSize &&
+               entry.x >= 0 && entry.y >= 0 && entry.w >= 0 && entry.h >= 0 &&
+               int64_t(entry.x) + entry.w <= head.width && int64_t(entry.y) + entry.h <= head.height;
+    }
+
+public:
+    AtlasCache()  = default;
+    ~AtlasCache() = default;
+
+    [[nodiscard]] inline bool           valid()      const { return header != nullptr; }
+    [[nodiscard]] inline size_t         entryCount() const { return valid() ? header->entryCount : 0; }
+    [[nodiscard]] inline Vector2i       getSize()    const { return valid() ? Vector2i(header->width, header->height) : Vector2i(0, 0); }
+    [[nodiscard]] inline const uint8_t* getPixels()  const { return pixels; }
+
+    [[nodiscard]] std::span<const Entry> getEntries() const
+    { return { entries, entryCount() }; }
+
+    [[nodiscard]] std::string_view getName(const Entry& entry) const
+    { return { names + entry.nameOffset, entry.nameSize }; }
+
+    // False if the file is missing, isn't a cache this version can read or has an entry out of range
+    bool load(const Path& path)
+    {
+        reset();
+
+        std::error_code err;
+        if (!fs::is_regular_file(path, err)) { return false; }
+
+        try { file = readFileBytes(path); }
+        catch (const FileReadError& e) { tlog::warn("AtlasCache: {}", e.what()); return false; }
+
+        Header head;
+        if (file.size() < sizeof(Header)) { file.clear(); return false; }
+        memcpy(&head, file.data(), sizeof(Header));
+
+        const size_t entriesSize = size_t(head.entryCount) * sizeof(Entry);
+        const size_t pixelsSize  = size_t(head.width) * head.height * 4;
+        if (head.magic != magic || head.version != version || head.width <= 0 || head.height <= 0 ||
+            file.size() != sizeof(Header) + entriesSize + head.namesSize + pixelsSize)
+        {
+            tlog::warn("AtlasCache: '{}' isn't a version {} atlas cache, ignoring it", path.string(), version);
+            file.clear();
+            return false;
+        }
+
+        // The buffer comes from the heap, which aligns it enough for the entries
+        const Entry* table = reinterpret_cast<const Entry*>(file.data() + sizeof(Header));
+        for (uint32_t i = 0; i < head.entryCount; ++i)
+        {
+            if (!entryInBounds(table[i], head))
+            {
+                tlog::warn("AtlasCache: Entry {} of '{}' is out of range, ignoring the cache", i, path.string());
+                file.clear();
+                return false;
+            }
+        }
+
+        header  = reinterpret_cast<const Header*>(file.data());
+        entries = table;
+        names   = file.data() + sizeof(Header) + entriesSize;
+        pixels  = reinterpret_cast<const uint8_t*>(names + head.namesSize);
+        return true;
+    }
+
+    void reset()
+    {
+        file.clear();
+        file.shrink_to_fit();
+        header  = nullptr;
+        entries = nullptr;
+        names   = nullptr;
+        pixels  = nullptr;
+    }
+
+    // nullptr if there's no entry called name
+    [[nodiscard]] const Entry* find(std::string_view name) const
+    {
+        const uint64_t hash = hashName(name);
+        const auto     all  = getEntries();
+        auto it = std::lower_bound(all.begin(), all.end(), hash, [](const Entry& e, uint64_t h) { return e.nameHash < h; });
+        for (; it != all.end() && it->nameHash == hash; ++it)
+        {
+            if (getName(*it) == name) { return &*it; }
+        }
+        return nullptr;
+    }
+
+    // True if source has the same size and write time as when entry was built from it
+    [[nodiscard]] static bool isUpToDate(const Entry& entry, const Path& source)
+    {
+        int64_t  time;
+        uint64_t size;
+        return stamp(source, time, size) && time == entry.sourceTime && size == entry.sourceSize;
+    }
+
+    // pixels are width * height RGBA texels, rows from the bottom
+    static bool write(const Path& path, Vector2i size, const uint8_t* atlasPixels, std::span<const Source> sources)
+    {
+        Vector<Entry> table;
+        String        namePool;
+        table.reserve(sources.size());
+        for (const Source& source : sources)
+        {
+            Entry& entry = table.emplace_back();
+            entry.nameHash   = hashName(source.name);
+            entry.x          = source.rect.x;
+            entry.y          = source.rect.y;
+            entry.w          = source.rect.width;
+            entry.h          = source.rect.height;
+            entry.nameOffset = uint32_t(namePool.size());
+            entry.nameSize   = uint32_t(source.name.size());
+            namePool += source.name;
+
+            if (!stamp(source.path, entry.sourceTime, entry.sourceSize))
+            {
+                tlog::error("AtlasCache: Can't read the write time of '{}'", source.path.string());
+                return false;
+            }
+        }
+        std::sort(table.begin(), table.end(), [](const Entry& a, const Entry& b) { return a.nameHash < b.nameHash; });
+        namePool.resize(padded(namePool.size()), '\0');
+
+        Header head     = {};
+        head.magic      = magic;
+        head.version    = version;
+        head.entryCount = uint32_t(table.size());
+        head.namesSize  = uint32_t(namePool.size());
+        head.width      = size.x;
+        head.height     = size.y;
+
+        std::error_code err;
+        if (!path.parent_path().empty()) { fs::create_directories(path.parent_path(), err); }
+
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&head), sizeof(Header));
+        out.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(Entry)));
+        out.write(namePool.data(), std::streamsize(namePool.size()));
+        out.write(reinterpret_cast<const char*>(atlasPixels), std::streamsize(size_t(size.x) * size.y * 4));
+        out.close();
+
+        if (out.fail())
+        {
+            tlog::error("AtlasCache: Failed to write '{}'", path.string());
+            return false;
+        }
+        return true;
+    }
+};
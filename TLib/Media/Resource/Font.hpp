@@ -6,8 +6,15 @@
 #include <TLib/Media/Renderer.hpp>
 #include <TLib/Media/Resource/Texture.hpp>
 #include <TLib/Types/Types.hpp>
+#include <TLib/Macros.hpp>
 #include <TLib/Containers/Vector.hpp>
+#include <TLib/Containers/Deque.hpp>
+#include <TLib/Containers/UnorderedMap.hpp>
+#include <TLib/Threading.hpp>
+#include <TLib/Pointers.hpp>
+#include <TLib/Files.hpp>
 #include <TLib/thirdparty/RectPack2D.hpp>
+#include <cstring>
 using namespace rectpack2D;
 
 struct FontChar
@@ -23,6 +30,7 @@ struct FontAtlasChar
     Recti    rect;
     Vector2i bearing;
     uint32_t advance;
+    uint32_t page = 0; // Atlas texture the glyph is in, see Font::getPage()
 };
 
 enum class FontRenderMode
@@ -33,7 +41,14 @@ enum class FontRenderMode
 
 struct FontDetail
 {
-    static inline FT_Library ft = nullptr;
+    static inline FT_Library       ft = nullptr;
+    static inline UPtr<ThreadPool> pool; // Renders glyphs in Font::loadFromFile()
+    static inline std::thread::id  mainThread; // The thread with the GL context, set by Renderer2D::init()
+
+    // Glyphs outside the preloaded range are only loaded and uploaded on the main thread, see Font::getGlyph()
+    static bool onMainThread()
+    { return mainThread == std::thread::id() || mainThread == std::this_thread::get_id(); }
+
     static void initFreetype()
     {
         if (ft != nullptr) return;
@@ -41,6 +56,20 @@ struct FontDetail
         { tlog::error("FREETYPE: Could not init FreeType Library"); }
     }
 
+    static ThreadPool& getPool()
+    {
+        if (!pool) { pool = makeUnique<ThreadPool>(); }
+        return *pool;
+    }
+
+    // FNV-1a, stable across builds unlike std::hash
+    static uint64_t hashBytes(const void* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++) { hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ull; }
+        return hash;
+    }
+
     static size_t getGlyphCount(FT_Face& face)
     {
         FT_UInt index;
@@ -59,6 +88,67 @@ struct FontDetail
 struct Font : NonAssignable
 {
 protected:
+    // Glyphs are about the same height, so lazy pages pack them in rows
+    struct ShelfPacker
+    {
+        struct Shelf
+        {
+            int32_t y;
+            int32_t height;
+            int32_t used; // Width taken so far
+        };
+
+        Vector<Shelf> shelves;
+        Vector2i      size;
+        int32_t       top = 0; // Height taken by the shelves
+
+        void reset(Vector2i newSize)
+        {
+            shelves.clear();
+            size = newSize;
+            top  = 0;
+        }
+
+        bool insert(Vector2i rect, Vector2i& pos)
+        {
+            Shelf* best = nullptr;
+            for (Shelf& shelf : shelves)
+            {
+                if (shelf.height >= rect.y && shelf.used + rect.x <= size.x && (!best || shelf.height < best->height))
+                { best = &shelf; }
+            }
+
+            // A new shelf wastes less than one much taller than the glyph
+            if ((!best || best->height > rect.y + rect.y / 2) && top + rect.y <= size.y && rect.x <= size.x)
+            {
+                best = &shelves.emplace_back(Shelf{ top, rect.y, 0 });
+                top += rect.y;
+            }
+            if (!best) { return false; }
+
+            pos         = Vector2i(best->used, best->y);
+            best->used += rect.x;
+            return true;
+        }
+    };
+
+    // An atlas for glyphs outside the preloaded range, filled as they're drawn
+    struct LazyPage
+    {
+        Texture          atlas;
+        ShelfPacker      packer;
+        Vector<char32_t> glyphs;       // In this page, dropped with it
+        uint64_t         lastUsed = 0; // Renderer::getFrameIndex()
+        uint32_t         pins     = 0; // StaticBatch2D recordings drawing from it, see pinPage()
+    };
+
+    // Size of every lazy page, clamped to Renderer::getMaxTextureSize()
+    static constexpr int32_t lazyPageSize = 1024;
+
+    // The least recently used lazy page is cleared to make room once there are this many.
+    // Pages drawn this frame or pinned aren't cleared, glyphs that don't fit then are drawn as the fallback.
+    static constexpr size_t  maxLazyPages = 4;
+
     Texture               textureAtlas;
     Vector<FontAtlasChar> characters;
     int32_t              _lineSpacing = 0;
@@ -66,30 +156,424 @@ protected:
     int32_t              _ascender    = 0;
     int32_t              _descender   = 0;
 
-    using Bitmap  = Vector<uint8_t>;
-    using Bitmaps = Vector<Bitmap>;
+    // Kept open to rasterize glyphs that aren't preloaded, see getGlyph()
+    Path                                  fontPath;
+    FT_Face                               face            = nullptr;
+    FontRenderMode                        renderMode      = FontRenderMode::SDF;
+    TextureFiltering                      filterMode      = TextureFiltering::Linear;
+    size_t                                rangeBegin      = 0; // Preloaded code points, indices into characters
+    size_t                                rangeEnd        = 0;
+    bool                                  lazyEnabled     = true;
+    Deque<LazyPage>                       lazyPages;
+    UnorderedMap<char32_t, FontAtlasChar> lazyGlyphs;
+    Atomic<uint64_t>                      _glyphGeneration = 0; // Read by the threads drawing with command lists
+    Atomic<bool>                          warnedOffThread  = false;
+    bool                                  warnedPagesFull  = false;
+    uint32_t                              _loadCount       = 0; // Bumped by loadFromFile(), pins from before it are gone
+
+    using Bitmap = Vector<uint8_t>;
+
+    // A glyph rendered by renderGlyph(), before it's packed
+    struct RenderedGlyph
+    {
+        FontAtlasChar ch;
+        Bitmap        bitmap; // Rows flipped like the atlas
+    };
+
+    // A FreeType library and face for one thread, FreeType objects can't be shared between threads
+    struct GlyphWorker
+    {
+        FT_Library library = nullptr;
+        FT_Face    face    = nullptr;
+    };
+
+    // Layout of the file written by writeCache():
+    // CacheHeader | CacheChar[charCount] | R8 atlas pixels, rows from the bottom
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fontHash;   // Of the font file's bytes
+        uint64_t rangeMin;   // As given to loadFromFile()
+        uint64_t rangeMax;
+        uint64_t rangeEnd;   // Last preloaded code point + 1
+        uint32_t size;
+        uint32_t renderMode;
+        uint32_t charCount;  // characters.size(), the fallback included
+        int32_t  ascender;
+        int32_t  descender;
+        int32_t  lineSpacing;
+        int32_t  width;      // Of the atlas
+        int32_t  height;
+    };
+
+    struct CacheChar
+    {
+        int32_t  x, y, w, h;
+        int32_t  bearingX, bearingY;
+        uint32_t advance;
+        uint32_t padding;
+    };
+    static_assert(sizeof(CacheHeader) % 8 == 0 && sizeof(CacheChar) % 8 == 0);
+
+    static constexpr uint32_t cacheMagic   = 0x464C4C54; // "TLLF"
+    static constexpr uint32_t cacheVersion = 2; // 2: The range isn't clamped to the font's glyph count
+
+    // One past the last Unicode code point, preloaded ranges stop there
+    static constexpr size_t maxCodePoint = 0x110000;
 
-    void copyFlippedYGlyph(Bitmaps& bitmaps, FT_Bitmap* bmp)
+    // Renders code point c with face, false if FreeType couldn't
+    static bool renderGlyph(FT_Face face, char32_t c, FontRenderMode mode, RenderedGlyph& out)
     {
         // Flip all bitmaps vertically, because OpenGL coords are weird.
         // https://stackoverflow.com/questions/26706036/flip-an-image-vertically
+        FT_GlyphSlot slot = face->glyph;
+        if (FT_Load_Char(face, c, FT_LOAD_DEFAULT) || FT_Render_Glyph(slot, static_cast<FT_Render_Mode_>(mode)))
+        { return false; }
+
+        const FT_Bitmap& bmp = slot->bitmap;
+        out.ch.bearing = Vector2i(slot->bitmap_left, slot->bitmap_top);
+        out.ch.advance = slot->advance.x;
+        out.ch.rect    = Recti(0, 0, bmp.width, bmp.rows);
+        out.ch.page    = 0;
+
+        out.bitmap.resize(size_t(bmp.width) * bmp.rows);
+        for (uint32_t r = 0; r < bmp.rows; r++)
+        {
+            const uint8_t* src = bmp.buffer + size_t(r) * bmp.pitch;
+            std::copy(src, src + bmp.width, &out.bitmap[size_t(bmp.rows - r - 1) * bmp.width]);
+        }
+        return true;
+    }
+
+    // Opens the face kept for glyphs outside the preloaded range, if it isn't open yet
+    bool openFace()
+    {
+        if (face) { return true; }
+
+        FontDetail::initFreetype();
+        if (FT_Error err = FT_New_Face(FontDetail::ft, fontPath.string().c_str(), 0, &face))
+        {
+            tlog::error("FREETYPE: Failed to load font '{}' Error code: {}", fontPath.string(), err);
+            face = nullptr;
+            return false;
+        }
+        FT_Select_Charmap(face, ft_encoding_unicode);
+        FT_Set_Pixel_Sizes(face, 0, _size);
+        return true;
+    }
+
+    /*
+    Renders code points [first, last), then the fallback glyph, spread over FontDetail's thread pool.
+    Every thread opens the font from fontFile with its own FreeType library. Glyphs the font doesn't have are left empty.
+    */
+    Vector<RenderedGlyph> renderGlyphs(const Vector<char>& fontFile, size_t first, size_t last)
+    {
+        const size_t          count = last - first;
+        Vector<RenderedGlyph> glyphs(count + 1);
+        std::mutex            workersMutex;
+        Vector<GlyphWorker>   idle;
 
-        Bitmap& flipped = bitmaps.emplace_back();
-        flipped.resize((size_t)bmp->width * bmp->rows);
+        auto acquire = [&]()
+        {
+            {
+                std::lock_guard lock(workersMutex);
+                if (!idle.empty())
+                {
+                    const GlyphWorker worker = idle.back();
+                    idle.pop_back();
+                    return worker;
+                }
+            }
+
+            GlyphWorker worker;
+            if (FT_Init_FreeType(&worker.library))
+            {
+                tlog::error("FREETYPE: Could not init FreeType Library");
+                worker.library = nullptr;
+                return worker;
+            }
+            if (FT_New_Memory_Face(worker.library, reinterpret_cast<const FT_Byte*>(fontFile.data()),
+                                   FT_Long(fontFile.size()), 0, &worker.face))
+            {
+                tlog::error("FREETYPE: Failed to load font '{}'", fontPath.string());
+                worker.face = nullptr;
+                return worker;
+            }
+            FT_Select_Charmap(worker.face, ft_encoding_unicode);
+            FT_Set_Pixel_Sizes(worker.face, 0, _size);
+            return worker;
+        };
+
+        // Rendering an SDF glyph takes long enough that small chunks balance best
+        FontDetail::getPool().parallelFor(count + 1, 16, [&](size_t begin, size_t end)
+        {
+            const GlyphWorker worker = acquire();
+            for (size_t i = begin; i < end && worker.face; i++)
+            {
+                // 0 is null https://www.cs.cmu.edu/~pattis/15-1XX/common/handouts/ascii.html
+                const bool     fallback = i == count;
+                const char32_t c        = fallback ? 0 : char32_t(first + i);
+                if (!fallback && !FT_Get_Char_Index(worker.face, c)) { continue; }
+
+                if (!renderGlyph(worker.face, c, renderMode, glyphs[i]))
+                { tlog::error("Failed to load character '{}' from font file '{}'", uint32_t(c), fontPath.string()); }
+            }
+
+            std::lock_guard lock(workersMutex);
+            idle.push_back(worker);
+        });
+
+        for (const GlyphWorker& worker : idle)
+        {
+            if (worker.face)    { FT_Done_Face(worker.face); }
+            if (worker.library) { FT_Done_FreeType(worker.library); }
+        }
+        return glyphs;
+    }
+
+    // The glyph has to be inside the atlas, a damaged file would draw from past it otherwise
+    static bool cacheCharInBounds(const CacheChar& ch, const CacheHeader& head)
+    {
+        return ch.x >= 0 && ch.y >= 0 && ch.w >= 0 && ch.h >= 0 &&
+               int64_t(ch.x) + ch.w <= head.width && int64_t(ch.y) + ch.h <= head.height;
+    }
+
+    // False if there's no cache at cachePath, or it was built from another font file or with other settings
+    bool loadCache(const Path& cachePath, uint64_t fontHash, size_t rangeMin, size_t rangeMax)
+    {
+        std::error_code err;
+        if (!fs::is_regular_file(cachePath, err)) { return false; }
+
+        Vector<char> file;
+        try { file = readFileBytes(cachePath); }
+        catch (const FileReadError& e) { tlog::warn("Font: {}", e.what()); return false; }
+
+        CacheHeader head;
+        if (file.size() < sizeof(CacheHeader)) { return false; }
+        memcpy(&head, file.data(), sizeof(CacheHeader));
+
+        if (head.magic != cacheMagic || head.version != cacheVersion || head.charCount != head.rangeEnd + 1 ||
+            head.width <= 0 || head.height <= 0 ||
+            file.size() != sizeof(CacheHeader) + size_t(head.charCount) * sizeof(CacheChar) + size_t(head.width) * head.height)
+        {
+            tlog::warn("Font: '{}' isn't a version {} font cache, ignoring it", cachePath.string(), cacheVersion);
+            return false;
+        }
 
-        auto& rows  = bmp->rows;
-        auto& width = bmp->width;
-        auto  components = 1;
+        if (head.fontHash != fontHash || head.size != _size || head.renderMode != uint32_t(renderMode) ||
+            head.rangeMin != rangeMin || head.rangeMax != rangeMax)
+        {
+            tlog::info("Font cache '{}' was built from another font or with other settings, loading again", cachePath.string());
+            return false;
+        }
 
-        for (size_t r = 0; r < rows; r++)
+        const char* cursor = file.data() + sizeof(CacheHeader);
+        characters.resize(head.charCount);
+        for (size_t i = 0; i < characters.size(); i++)
         {
-            auto src = &bmp->buffer[r * components * width];
-            auto dst = &flipped[(rows - r - 1) * components * width];
-            std::copy(src, src + components*width, dst);
+            CacheChar cached;
+            memcpy(&cached, cursor, sizeof(CacheChar));
+            cursor += sizeof(CacheChar);
+
+            if (!cacheCharInBounds(cached, head))
+            {
+                tlog::warn("Font: Glyph {} of '{}' is out of range, ignoring the cache", i, cachePath.string());
+                characters.clear();
+                return false;
+            }
+
+            FontAtlasChar& ch = characters[i];
+            ch.rect    = Recti(cached.x, cached.y, cached.w, cached.h);
+            ch.bearing = Vector2i(cached.bearingX, cached.bearingY);
+            ch.advance = cached.advance;
+            ch.page    = 0;
         }
+
+        _ascender    = head.ascender;
+        _descender   = head.descender;
+        _lineSpacing = head.lineSpacing;
+        rangeEnd     = head.rangeEnd;
+        rangeBegin   = std::min<size_t>(rangeMin, rangeEnd);
+
+        uploadAtlas(cursor, head.width, head.height);
+        return true;
+    }
+
+    void writeCache(const Path& cachePath, uint64_t fontHash, size_t rangeMin, size_t rangeMax,
+                    const Bitmap& pixels, Vector2i atlasSize)
+    {
+        CacheHeader head = {};
+        head.magic       = cacheMagic;
+        head.version     = cacheVersion;
+        head.fontHash    = fontHash;
+        head.rangeMin    = rangeMin;
+        head.rangeMax    = rangeMax;
+        head.rangeEnd    = rangeEnd;
+        head.size        = _size;
+        head.renderMode  = uint32_t(renderMode);
+        head.charCount   = uint32_t(characters.size());
+        head.ascender    = _ascender;
+        head.descender   = _descender;
+        head.lineSpacing = _lineSpacing;
+        head.width       = atlasSize.x;
+        head.height      = atlasSize.y;
+
+        Vector<CacheChar> table;
+        table.reserve(characters.size());
+        for (const FontAtlasChar& ch : characters)
+        {
+            table.push_back(CacheChar{ ch.rect.x, ch.rect.y, ch.rect.width, ch.rect.height,
+                                       ch.bearing.x, ch.bearing.y, ch.advance, 0 });
+        }
+
+        std::error_code err;
+        if (!cachePath.parent_path().empty()) { fs::create_directories(cachePath.parent_path(), err); }
+
+        std::ofstream out(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&head), sizeof(CacheHeader));
+        out.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(CacheChar)));
+        out.write(reinterpret_cast<const char*>(pixels.data()), std::streamsize(pixels.size()));
+        out.close();
+
+        if (out.fail()) { tlog::error("Font: Failed to write '{}'", cachePath.string()); }
+        else            { tlog::info("Saved the glyphs of '{}' to '{}'", fontPath.string(), cachePath.string()); }
+    }
+
+    void uploadAtlas(const void* pixels, int32_t width, int32_t height)
+    {
+        textureAtlas.create();
+        textureAtlas.setUnpackAlignment(1);
+        textureAtlas.setData(pixels, width, height, TexPixelFormats::RED, TexInternalFormats::RED);
+        textureAtlas.setFilter(filterMode);
+    }
+
+    void closeFace()
+    {
+        if (face) { FT_Done_Face(face); }
+        face = nullptr;
+    }
+
+    static int32_t lazyPageExtent()
+    { return std::min(lazyPageSize, Renderer::getMaxTextureSize()); }
+
+    LazyPage& addLazyPage()
+    {
+        const int32_t size = lazyPageExtent();
+        LazyPage& page = lazyPages.emplace_back();
+        page.packer.reset(Vector2i(size, size));
+        page.atlas.create();
+        page.atlas.setData(NULL, size, size, TexPixelFormats::RED, TexInternalFormats::RED);
+        page.atlas.setFilter(filterMode);
+        page.atlas.setUnpackAlignment(1);
+        return page;
+    }
+
+    // Finds room for a rect no bigger than a page in the lazy pages.
+    // Returns the page index, counting the preloaded atlas as page 0, or 0 if every page is full and can't be cleared.
+    uint32_t placeLazyGlyph(Vector2i rect, Vector2i& pos)
+    {
+        // Newest pages have the most room
+        for (size_t i = lazyPages.size(); i-- > 0;)
+        {
+            if (lazyPages[i].packer.insert(rect, pos)) { return uint32_t(i + 1); }
+        }
+
+        if (lazyPages.size() < maxLazyPages)
+        {
+            addLazyPage();
+            lazyPages.back().packer.insert(rect, pos);
+            return uint32_t(lazyPages.size());
+        }
+
+        // Pages used this frame can't be cleared, draw calls queued with their glyphs haven't been drawn yet.
+        // Pinned ones can't either, StaticBatch2D recordings keep their uvs.
+        const uint64_t frame  = Renderer::getFrameIndex();
+        size_t         oldest = lazyPages.size();
+        for (size_t i = 0; i < lazyPages.size(); i++)
+        {
+            const LazyPage& page = lazyPages[i];
+            if (page.pins > 0 || page.lastUsed == frame) { continue; }
+            if (oldest == lazyPages.size() || page.lastUsed < lazyPages[oldest].lastUsed) { oldest = i; }
+        }
+        if (oldest == lazyPages.size()) { return 0; }
+
+        LazyPage& page = lazyPages[oldest];
+        for (const char32_t c : page.glyphs) { lazyGlyphs.erase(c); }
+        page.glyphs.clear();
+        page.packer.reset(page.packer.size);
+        ++_glyphGeneration;
+
+        page.packer.insert(rect, pos);
+        return uint32_t(oldest + 1);
+    }
+
+    // Rasterizes c into a lazy page the first time it's drawn.
+    // Code points the font doesn't have map to the fallback glyph, so they're only looked up once.
+    const FontAtlasChar& loadLazyGlyph(char32_t c)
+    {
+        ASSERT(FontDetail::onMainThread()); // FreeType and the page uploads need the GL context's thread
+        FontAtlasChar& ch = lazyGlyphs[c];
+        ch = getFallbackChar();
+        if (!openFace() || !FT_Get_Char_Index(face, c)) { return ch; }
+
+        RenderedGlyph glyph;
+        if (!renderGlyph(face, c, renderMode, glyph))
+        {
+            tlog::error("Font: Failed to load character '{}'", uint32_t(c));
+            return ch;
+        }
+
+        ch = glyph.ch;
+        const Vector2i size = ch.rect.getSize();
+        if (size.x == 0 || size.y == 0) { return ch; } // Nothing to draw, like a space
+
+        // Uploaded with a blank texel around it, which also clears whatever was there before the page was reused
+        constexpr int32_t pad = 1;
+        const Vector2i padded(size.x + pad * 2, size.y + pad * 2);
+        if (padded.x > lazyPageExtent() || padded.y > lazyPageExtent())
+        {
+            tlog::error("Font: Character '{}' is bigger than a glyph page", uint32_t(c));
+            ch = getFallbackChar();
+            return ch;
+        }
+
+        Vector2i       pos;
+        const uint32_t page = placeLazyGlyph(padded, pos);
+        if (page == 0)
+        {
+            if (!warnedPagesFull)
+            {
+                tlog::warn("Font: '{}' has {} glyph pages in use, glyphs that don't fit are drawn as the fallback "
+                           "until one can be cleared", fontPath.string(), maxLazyPages);
+                warnedPagesFull = true;
+            }
+            lazyGlyphs.erase(c); // Loaded again the next time it's drawn
+            return getFallbackChar();
+        }
+
+        Bitmap pixels(size_t(padded.x) * padded.y, 0);
+        for (int32_t r = 0; r < size.y; r++)
+        {
+            const uint8_t* src = &glyph.bitmap[size_t(r) * size.x];
+            std::copy(src, src + size.x, &pixels[size_t(r + pad) * padded.x + pad]);
+        }
+
+        LazyPage& lazy = lazyPages[page - 1];
+        lazy.atlas.setSubData(pixels.data(), padded.x, padded.y, pos.x, pos.y, TexPixelFormats::RED);
+        lazy.glyphs.push_back(c);
+        lazy.lastUsed = Renderer::getFrameIndex();
+
+        ch.rect.x = pos.x + pad;
+        ch.rect.y = pos.y + pad;
+        ch.page   = page;
+        return ch;
     }
 
 public:
+    Font()  = default;
+    ~Font() { closeFace(); }
+
     [[nodiscard]]
     inline FontAtlasChar& getChar(size_t c)
     { return characters.at(c); }
@@ -124,46 +608,145 @@ public:
     Texture& getAtlas()
     { return textureAtlas; }
 
+    // Texture of a glyph's FontAtlasChar::page. Page 0 is getAtlas(), the rest hold glyphs loaded as they're drawn.
     [[nodiscard]]
-    Vector2f calcTextSize(const String& text, float scale = 1.f)
+    Texture& getPage(uint32_t page)
+    { return page == 0 ? textureAtlas : lazyPages[page - 1].atlas; }
+
+    [[nodiscard]]
+    inline size_t pageCount() const
+    { return lazyPages.size() + 1; }
+
+    /*
+    Keeps a lazy page from being cleared to make room, for StaticBatch2D recordings that keep their glyphs' uvs.
+    loadCount() is passed to unpinPage() so pins from before a loadFromFile() are dropped with the pages they were on.
+    */
+    void pinPage(uint32_t page)
     {
-        Vector2f cursor;
+        if (page == 0) { return; }
+        ++lazyPages[page - 1].pins;
+    }
 
-        float maxX = 0.f;
-        float maxY = 0.f;
+    void unpinPage(uint32_t page, uint32_t loadCount)
+    {
+        if (page == 0 || loadCount != _loadCount || page > lazyPages.size()) { return; }
+        LazyPage& lazy = lazyPages[page - 1];
+        if (lazy.pins > 0) { --lazy.pins; }
+    }
 
-        const auto linespacing = lineSpacing();
+    [[nodiscard]]
+    inline uint32_t loadCount() const
+    { return _loadCount; }
+
+    // Changes whenever glyphs already handed out by getGlyph() move, so anything laid out with them has to be redone
+    [[nodiscard]]
+    inline uint64_t glyphGeneration() const
+    { return _glyphGeneration.load(std::memory_order_relaxed); }
+
+    // Marks a page as drawn this frame, so it isn't cleared before it's drawn. getGlyph() does this.
+    void touchPage(uint32_t page)
+    {
+        if (page == 0) { return; }
+        ASSERT(FontDetail::onMainThread()); // Other threads only get glyphs of page 0, see getGlyph()
+        lazyPages[page - 1].lastUsed = Renderer::getFrameIndex();
+    }
 
-        for (auto& strchar : text)
+    /*
+    When enabled (the default), code points outside the range given to loadFromFile() are rasterized into extra
+    atlas pages the first time they're drawn, instead of drawing the fallback glyph.
+    Pages are cleared least recently used first once there are maxLazyPages, pages drawn this frame or pinned by a
+    StaticBatch2D recording are never cleared. Glyphs that don't fit then are drawn as the fallback until one can be.
+    Glyphs are loaded with FreeType and uploaded on the main thread. Other threads, like ones drawing into a
+    Renderer2D::CommandList, get the fallback glyph for anything outside the preloaded range, so preload what they draw.
+    */
+    void setLazyGlyphsEnabled(bool enabled)
+    {
+        if (enabled != lazyEnabled) { ++_glyphGeneration; } // Loaded glyphs turn into the fallback or back
+        lazyEnabled = enabled;
+    }
+
+    [[nodiscard]]
+    inline bool isLazyGlyphsEnabled() const
+    { return lazyEnabled; }
+
+    // The glyph drawn for code point c, the fallback glyph if the font doesn't have it.
+    // Off the main thread only the preloaded range is drawn, the lazy pages are the main thread's.
+    [[nodiscard]]
+    const FontAtlasChar& getGlyph(char32_t c)
+    {
+        if (c >= rangeBegin && c < rangeEnd) { return characters[c]; }
+        if (!lazyEnabled)                    { return characters.back(); }
+
+        if (!FontDetail::onMainThread())
         {
-            if (!containsChar(strchar)) { continue; }
-            FontAtlasChar& ch = characters.at(strchar);
+            if (!warnedOffThread.exchange(true))
+            {
+                tlog::warn("Font: '{}' drew code point {} off the main thread, it's outside the preloaded range so "
+                           "it's drawn as the fallback glyph there", fontPath.string(), uint32_t(c));
+            }
+            return characters.back();
+        }
 
-            if (strchar == '\n')
+        if (auto it = lazyGlyphs.find(c); it != lazyGlyphs.end())
+        {
+            touchPage(it->second.page);
+            return it->second;
+        }
+        return loadLazyGlyph(c);
+    }
+
+    /*
+    Lays UTF-8 text out the way Renderer2D::drawText() draws it, calling fn(glyph, pen) for every glyph.
+    pen is the glyph's point on the baseline, relative to the start of the first line.
+    Returns the furthest the pen got on x and y, lines are lineSpacing() * scale apart.
+    */
+    template <typename Fn>
+    Vector2f layoutText(std::string_view text, float scale, Fn&& fn)
+    {
+        Vector2f pen;
+        Vector2f extent;
+        forEachCodePoint(text, [&](char32_t c)
+        {
+            if (c == '\n')
             {
-                cursor.x = 0;
-                cursor.y += linespacing;
+                pen.x  = 0.f;
+                pen.y += float(_lineSpacing) * scale;
             }
             else
             {
-                cursor.x += (ch.advance >> 6) * scale;
+                const FontAtlasChar& ch = getGlyph(c);
+                fn(ch, pen);
+                pen.x += float(ch.advance >> 6) * scale;
             }
 
-            maxX = std::max(maxX, cursor.x);
-            maxY = std::max(maxY, cursor.y);
-        }
-        return Vector2f(maxX, maxY);
+            extent.x = std::max(extent.x, pen.x);
+            extent.y = std::max(extent.y, pen.y);
+        });
+        return extent;
+    }
+
+    // Size of the text drawn with Renderer2D::drawText(), not counting the height of the last line
+    [[nodiscard]]
+    Vector2f calcTextSize(std::string_view text, float scale = 1.f)
+    {
+        if (!created()) { return Vector2f(0.f, 0.f); }
+        return layoutText(text, scale, [](const FontAtlasChar&, const Vector2f&) { });
     }
 
-    SubTexture getCharTex(size_t c)
+    SubTexture getCharTex(char32_t c)
     {
-        return SubTexture(getAtlas(), Rectf(getChar(c).rect));
+        const FontAtlasChar& ch = getGlyph(c);
+        return SubTexture(getPage(ch.page), Rectf(ch.rect));
     }
 
     /*
     If you're using a low resolution font, like a pixel art font, consider setting:
     renderMode    = FontRenderMode::Normal     and/or
     texFilterMode = TextureFiltering::Nearest
+
+    Glyphs are rendered on every core. With a cachePath, the packed atlas and glyph metrics are saved there,
+    and later loads of the same font file with the same size, range and render mode read it back instead
+    of rendering anything. Load fonts from one thread at a time.
     */
     bool loadFromFile(
         const Path&      path,
@@ -171,31 +754,48 @@ public:
         size_t           rangeMin      = 0,
         size_t           rangeMax      = 128,
         FontRenderMode   renderMode    = FontRenderMode::SDF,
-        TextureFiltering texFilterMode = TextureFiltering::Linear)
+        TextureFiltering texFilterMode = TextureFiltering::Linear,
+        const Path&      cachePath     = Path())
     {
         ///// Load font and cache basic details
-        FontDetail::initFreetype();
         characters.clear();
-        FT_Face face;
-        FT_Error err = FT_New_Face(FontDetail::ft, path.string().c_str(), 0, &face);
-        if (err)
+        lazyPages .clear();
+        lazyGlyphs.clear();
+        closeFace();
+        ++_glyphGeneration;
+        ++_loadCount;
+        rangeBegin = rangeEnd = 0;
+
+        fontPath         = path;
+        _size            = size;
+        this->renderMode = renderMode;
+        filterMode       = texFilterMode;
+
+        // Hashed to find out if the cache is of this font, and shared by the threads that render glyphs
+        Vector<char> fontFile;
+        try { fontFile = readFileBytes(path); }
+        catch (const FileReadError&)
         {
-            tlog::error("FREETYPE: Failed to load font '{}' Error code: {}", path.string(), err);
+            tlog::error("FREETYPE: Failed to load font '{}'", path.string());
             return false;
         }
-        FT_Select_Charmap(face, ft_encoding_unicode);
-        FT_Set_Pixel_Sizes(face, 0, size);
-        FT_GlyphSlot slot =  face->glyph;
-        FT_Bitmap*   bmp  = &slot->bitmap;
+        const uint64_t fontHash = FontDetail::hashBytes(fontFile.data(), fontFile.size());
 
-        size_t charCount = FontDetail::getGlyphCount(face);
-        charCount = std::min(charCount, rangeMax);
-        characters.resize(charCount);
+        if (!cachePath.empty() && loadCache(cachePath, fontHash, rangeMin, rangeMax))
+        {
+            tlog::info("Loaded the glyphs of '{}' from '{}'", path.string(), cachePath.string());
+            return true;
+        }
+
+        if (!openFace()) { return false; }
+
+        // The code points asked for, not the font's glyph count, which has nothing to do with where its code points are
+        const size_t charCount = std::min(rangeMax, maxCodePoint);
+        const size_t firstChar = std::min(rangeMin, charCount);
         _ascender    =  face->size->metrics.ascender >> 6;
         _descender   =  face->size->metrics.descender >> 6;
         _lineSpacing = (face->size->metrics.ascender - face->size->metrics.descender) >> 6;
         //_lineSpacing = static_cast<float>(face->size->metrics.height) / float{1 << 6};
-        _size = size;
 
         // DONE: Pack glyphs better, theres tons of wasted space!!!
         // Used rectpack2d for nice packing :)
@@ -205,8 +805,12 @@ public:
         // Profiler says most of the time is spent in FT_Render_Glyph
         // Started copying the first call to FT_Render_Glyph and using that for second iteration
         // It's not painfully slow anymore yeehaw
+        // FT_Render_Glyph is spread over every core now, and the result can be cached
 
-        ///// Loop through chars once to find minimum size needed to pack everything
+        ///// Render every glyph once, the last one is the fallback character
+        Vector<RenderedGlyph> glyphs = renderGlyphs(fontFile, firstChar, charCount);
+
+        ///// Find the minimum size needed to pack everything
         const auto maxTexSize = Renderer::getMaxTextureSize();
         const auto discard_step = -4;
         using spaces_type = rectpack2D::empty_spaces<false>;
@@ -216,88 +820,49 @@ public:
         auto report_unsuccessful = [](rect_type&) { return callback_result::ABORT_PACKING; };
 
         std::vector<rect_type> rects;
-        rects.reserve(charCount);
-        Bitmaps bitmaps;
-        bitmaps.reserve(charCount);
-
-        for (size_t c = rangeMin; c < charCount; c++)
-        {
-            if (!FT_Get_Char_Index(face, c))
-            {
-                rects.emplace_back(rect_xywh());
-                bitmaps.emplace_back();
-                continue;
-            }
-
-            if (FT_Load_Char(face, c, FT_LOAD_DEFAULT))
-            { tlog::error("Failed to load character '{}' from font file '{}'", c, path.string()); continue; }
-
-            FT_Render_Glyph(slot, static_cast<FT_Render_Mode_>(renderMode));
-            
-            // Save glyph rect for packing, and save bitmap buffer for second iteration
-            rects.emplace_back(rect_xywh(0, 0, bmp->width, bmp->rows));
-            copyFlippedYGlyph(bitmaps, bmp);
-
-            //// Write their info into the char map so we can actually use them
-            FontAtlasChar& ch = characters.at(c);
-            ch.bearing        = Vector2i(slot->bitmap_left, slot->bitmap_top);
-            ch.advance        = slot->advance.x;
-            ch.rect.width     = slot->bitmap.width;
-            ch.rect.height    = slot->bitmap.rows;
-        }
-
-        /// Save a fallback character
-        // 0 is null https://www.cs.cmu.edu/~pattis/15-1XX/common/handouts/ascii.html
-        FT_Load_Char(face, 0, FT_LOAD_DEFAULT);
-        FT_Render_Glyph(slot, static_cast<FT_Render_Mode_>(renderMode));
-        copyFlippedYGlyph(bitmaps, bmp);
-        rects.emplace_back(rect_xywh(0, 0, bmp->width, bmp->rows));
-
-        FontAtlasChar& ch = characters.emplace_back();
-        ch.bearing        = Vector2i(slot->bitmap_left, slot->bitmap_top);
-        ch.advance        = slot->advance.x;
-        ch.rect.width     = slot->bitmap.width;
-        ch.rect.height    = slot->bitmap.rows;
+        rects.reserve(glyphs.size());
+        for (const RenderedGlyph& glyph : glyphs)
+        { rects.emplace_back(rect_xywh(0, 0, glyph.ch.rect.width, glyph.ch.rect.height)); }
 
         const auto result_size = find_best_packing<spaces_type>(rects,
             make_finder_input(maxTexSize, discard_step, report_successful, report_unsuccessful, flipping_option::DISABLED));
 
-        // Surely this wont happen... surely?
-        // TODO: Use a 3D texture to fit more characters in this case
+        // Glyphs outside the range are loaded as they're drawn, so big ranges don't need to be preloaded
         if (result_size.w > maxTexSize || result_size.h > maxTexSize)
         {
-            tlog::critical("The font '{}' is too large for a texture atlas! try reducing the size or range.", path.string());
+            tlog::critical("The font '{}' is too large for a texture atlas! Try reducing the size or range, "
+                           "characters outside of it are loaded when they're drawn.", path.string());
+            closeFace();
             return false;
         }
 
-        //// Create texture using the size we found
-        textureAtlas.create();
-        textureAtlas.setData(NULL, result_size.w, result_size.h, TexPixelFormats::RED, TexInternalFormats::RED);
-        textureAtlas.setFilter(texFilterMode);
-        textureAtlas.setUnpackAlignment(1);
-
-        //// Loop through saved sdf bitmaps,
-        //// load them into GPU texture using the positions we found with rectpack2d
-        for (size_t i = 0; i < characters.size(); i++)
+        ///// Copy the glyphs to the positions we found with rectpack2d, and upload them at once
+        Bitmap pixels(size_t(result_size.w) * result_size.h, 0);
+        characters.resize(charCount);
+        for (size_t i = 0; i < glyphs.size(); i++)
         {
-            auto& bitmap = bitmaps[i];
-            if (bitmap.empty()) { continue; }
-
-            FontAtlasChar& ch = characters.at(i);
-
-            auto x = rects[i].x;
-            auto y = rects[i].y;
+            FontAtlasChar& ch = glyphs[i].ch;
+            ch.rect.x = rects[i].x;
+            ch.rect.y = rects[i].y;
 
-            textureAtlas.setSubData(bitmap.data(), ch.rect.width, ch.rect.height,
-                x, y, TexPixelFormats::RED);
+            const Bitmap& bitmap = glyphs[i].bitmap;
+            for (int32_t row = 0; row < ch.rect.height; row++)
+            {
+                const uint8_t* src = &bitmap[size_t(row) * ch.rect.width];
+                std::copy(src, src + ch.rect.width, &pixels[size_t(ch.rect.y + row) * result_size.w + ch.rect.x]);
+            }
 
-            // Write their assigned positions
-            ch.rect.x = x;
-            ch.rect.y = y;
+            if (i + 1 < glyphs.size()) { characters[firstChar + i] = ch; }
+            else                       { characters.push_back(ch); }
         }
+        uploadAtlas(pixels.data(), result_size.w, result_size.h);
+
+        // All done, yeehaw. The face stays open for the glyphs outside the range.
+        rangeBegin = firstChar;
+        rangeEnd   = charCount;
 
-        // All done, yeehaw
-        FT_Done_Face(face);
+        if (!cachePath.empty())
+        { writeCache(cachePath, fontHash, rangeMin, rangeMax, pixels, Vector2i(result_size.w, result_size.h)); }
         return true;
     }
 };
@@ -14,6 +14,8 @@
 
 struct GPUVertexData : NonCopyable
 {
+    static constexpr uint32_t maxStreamFrames = 4; // See setStreamFrameCount()
+
 protected:
     using Layout = TLib::Layout;
 
@@ -24,6 +26,48 @@ protected:
     uint32_t     _vertexCount = 0;
     uint32_t     _indiceCount = 0;
 
+    // Streaming ring, see setStreamCapacity()
+    uint32_t     _streamVertexCapacity = 0;
+    uint32_t     _streamIndiceCapacity = 0;
+    uint32_t     _streamVertexHead     = 0;
+    uint32_t     _streamIndiceHead     = 0;
+
+    // Frames in flight, see setStreamFrameCount()
+    uint32_t     _streamFrameCount = 1;
+    uint32_t     _streamFrame      = 0;
+    GLsync       _streamFences[maxStreamFrames] = {};
+
+    void deleteStreamFences()
+    {
+        for (GLsync& fence : _streamFences)
+        {
+            if (fence) { glDeleteSync(fence); }
+            fence = nullptr;
+        }
+    }
+
+    // Points the attributes of _layout at the bound vbo, starting at baseOffset bytes
+    void pointAttributes(size_t baseOffset)
+    {
+        GLuint  index  = 0;
+        size_t  offset = baseOffset;
+        GLsizei stride = _layout.sizeBytes();
+
+        for (const auto& l : _layout.getValues())
+        {
+            GL_CHECK(glEnableVertexAttribArray(index));
+            GL_CHECK(glVertexAttribPointer(index, l.size(), static_cast<GLenum>(l.type()),
+                                           l.normalized() ? GL_TRUE : GL_FALSE, stride, (GLvoid*)(offset)));
+            if (l.divisor())
+            { GL_CHECK(glVertexAttribDivisor(index, l.divisor())); }
+            ++index;
+            offset += l.sizeBytes();
+        }
+
+        if (_layout.getValues().size() > 0)
+        { ASSERT(index > 0); }
+    }
+
     void move(GPUVertexData& src)
     {
         vao          = eastl::move(src.vao);
@@ -32,11 +76,36 @@ protected:
         _layout      = src._layout;
         _vertexCount = src._vertexCount;
         _indiceCount = src._indiceCount;
+
+        _streamVertexCapacity = src._streamVertexCapacity;
+        _streamIndiceCapacity = src._streamIndiceCapacity;
+        _streamVertexHead     = src._streamVertexHead;
+        _streamIndiceHead     = src._streamIndiceHead;
+
+        _streamFrameCount = src._streamFrameCount;
+        _streamFrame      = src._streamFrame;
+        for (uint32_t i = 0; i < maxStreamFrames; i++)
+        {
+            _streamFences[i]     = src._streamFences[i];
+            src._streamFences[i] = nullptr;
+        }
     }
 
 public:
+    // A range of a streaming buffer returned by mapStream()
+    template <typename T>
+    struct StreamRange
+    {
+        T*        vertices    = nullptr;
+        uint32_t* indices     = nullptr;
+        uint32_t  vertexCount = 0;
+        uint32_t  indiceCount = 0;
+        uint32_t  baseVertex  = 0; // Offset of the first vertex in the vertex buffer
+        uint32_t  firstIndex  = 0; // Offset of the first index in the index buffer
+    };
+
     GPUVertexData()  = default;
-    ~GPUVertexData() = default;
+    ~GPUVertexData() { deleteStreamFences(); }
 
     // Movable only
     GPUVertexData(GPUVertexData&& src)            noexcept { move(src); }
@@ -49,6 +118,8 @@ public:
     [[nodiscard]] inline const Layout   layout()        const { return _layout; }
     [[nodiscard]] inline const uint32_t vertexCount()   const { return _vertexCount; }
     [[nodiscard]] inline const uint32_t indiceCount()   const { return _indiceCount; }
+    [[nodiscard]] inline const bool     streaming()     const { return _streamVertexCapacity > 0; }
+    [[nodiscard]] inline const uint32_t streamFrameCount() const { return _streamFrameCount; }
 
     void reset()
     {
@@ -58,6 +129,15 @@ public:
         _layout.clear();
         _vertexCount = 0;
         _indiceCount = 0;
+
+        _streamVertexCapacity = 0;
+        _streamIndiceCapacity = 0;
+        _streamVertexHead     = 0;
+        _streamIndiceHead     = 0;
+
+        deleteStreamFences();
+        _streamFrameCount = 1;
+        _streamFrame      = 0;
     }
 
     bool bind()
@@ -84,26 +164,20 @@ public:
         vao.bind();
         vbo.bind();
 
-        GLuint   index  = 0;
-        uint32_t offset = 0;
-        GLsizei  stride = layout.sizeBytes();
-
-        for (const auto& l : layout.getValues())
-        {
-            GL_CHECK(glEnableVertexAttribArray(index));
-            GL_CHECK(glVertexAttribPointer(index, l.size(), static_cast<GLenum>(l.type()),
-                                           GL_FALSE, stride, (GLvoid*)(offset)));
-            if (l.divisor())
-            { GL_CHECK(glVertexAttribDivisor(index, l.divisor())); }
-            ++index;
-            offset += l.sizeBytes();
-        }
-
         _layout = layout;
+        pointAttributes(0);
+    }
 
-        if (layout.getValues().size() > 0)
-        { ASSERT(index > 0); }
-
+    /**
+     * Makes vertex 0 of the next draw read from firstVertex in the vertex buffer.
+     * Used to draw instances from the middle of a streaming buffer, since GL 3.3 has no base instance.
+     */
+    void setAttributeOffset(uint32_t firstVertex)
+    {
+        ASSERT(validLayout());
+        vao.bind();
+        vbo.bind();
+        pointAttributes(size_t(firstVertex) * _layout.sizeBytes());
     }
 
     template <typename ContainerType>
@@ -154,4 +228,162 @@ public:
         _indiceCount = 0;
         ebo.reset();
     }
+
+    /**
+     * Puts the buffers in streaming mode.
+     * Storage is allocated once, then mapStream() hands out consecutive sub ranges of it.
+     * When the ring is full the storage is orphaned and writing starts over at the beginning,
+     * so the driver never has to wait on ranges the GPU is still reading.
+     * Draw the mapped ranges with Renderer::drawStream(), or Renderer::drawInstanced() for instance data.
+     * indiceCapacity can be 0 for streams that never map indices.
+     */
+    void setStreamCapacity(uint32_t vertexCapacity, uint32_t indiceCapacity)
+    {
+        ASSERT(validLayout()); // Layout must be set before streaming
+        ASSERT(vertexCapacity > 0);
+
+        if (indiceCapacity > 0 && !ebo.created()) { ebo.create(); }
+
+        rendlog->info("Setting mesh stream capacity: Vertices={}; Indices={}; Bytes={};",
+            vertexCapacity, indiceCapacity, size_t(vertexCapacity) * _layout.sizeBytes() + size_t(indiceCapacity) * sizeof(uint32_t));
+
+        _streamVertexCapacity = vertexCapacity;
+        _streamIndiceCapacity = indiceCapacity;
+        orphanStream();
+    }
+
+    /**
+     * Splits the stream into frameCount regions of the current capacity, one per frame in flight.
+     * With more than 1 frame, beginStreamFrame() moves to the next region and waits on the fence
+     * fenceStream() left on it, instead of orphaning the whole buffer when it's full.
+     * The CPU can then fill one region while the GPU still reads the others.
+     * 1 (the default) is the plain orphaning ring.
+     */
+    void setStreamFrameCount(uint32_t frameCount)
+    {
+        ASSERT(streaming()); // Call setStreamCapacity() first
+        ASSERT(frameCount > 0 && frameCount <= maxStreamFrames);
+        if (frameCount == _streamFrameCount) { return; }
+
+        rendlog->info("Setting mesh stream frame count: {}", frameCount);
+        _streamFrameCount = frameCount;
+        orphanStream();
+    }
+
+    /**
+     * Starts writing to the region of the next frame, waiting for the GPU to be done with it first.
+     * Call it once per frame before the first mapStream(). Does nothing with 1 frame.
+     */
+    void beginStreamFrame()
+    {
+        if (_streamFrameCount <= 1 || !streaming()) { return; }
+
+        _streamFrame = (_streamFrame + 1) % _streamFrameCount;
+
+        GLsync& fence = _streamFences[_streamFrame];
+        if (fence)
+        {
+            // Usually signaled already, frameCount frames have passed since it was placed
+            constexpr GLuint64 timeout = 1000000000; // 1 second, in nanoseconds
+            GLenum result;
+            do { result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout); }
+            while (result == GL_TIMEOUT_EXPIRED);
+            ASSERTMSG(result != GL_WAIT_FAILED, "glClientWaitSync failed");
+
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        _streamVertexHead = _streamFrame * _streamVertexCapacity;
+        _streamIndiceHead = _streamFrame * _streamIndiceCapacity;
+    }
+
+    // Marks the end of the draws reading the current region, call it after the last draw of the frame
+    void fenceStream()
+    {
+        if (_streamFrameCount <= 1 || !streaming()) { return; }
+
+        GLsync& fence = _streamFences[_streamFrame];
+        if (fence) { glDeleteSync(fence); } // The new fence covers the older draws too
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    /**
+     * Maps the next vertexCount vertices and indiceCount indices of the streaming ring for writing.
+     * Only write to the returned pointers, and call unmapStream() before drawing.
+     * Grows the ring if the range doesn't fit.
+     * With several frames in flight the range comes from the region of the current frame.
+     */
+    template <typename T>
+    StreamRange<T> mapStream(uint32_t vertexCount, uint32_t indiceCount)
+    {
+        ASSERT(streaming()); // Call setStreamCapacity() first
+        ASSERT(vertexCount > 0);
+
+        #ifdef TLIB_DEBUG
+        if (sizeof(T) != _layout.sizeBytes())
+        {
+            tlog::critical("The size of the value Type: ({}) Size: ({}) does not match the size of the layout ({})",
+                typeid(T).name(), sizeof(T), _layout.sizeBytes());
+            ASSERT(false); // Layout and data size mismatch
+        }
+        #endif
+
+        if (vertexCount > _streamVertexCapacity || indiceCount > _streamIndiceCapacity)
+        {
+            setStreamCapacity(std::max(vertexCount, _streamVertexCapacity * 2),
+                              std::max(indiceCount, _streamIndiceCapacity * 2));
+        }
+        else if (_streamVertexHead + vertexCount > (_streamFrame + 1) * _streamVertexCapacity ||
+                 _streamIndiceHead + indiceCount > (_streamFrame + 1) * _streamIndiceCapacity)
+        { orphanStream(); }
+
+        // Nothing written before the head is touched again until the storage is orphaned,
+        // or until the fence of its region has been waited on, so the range can be mapped without synchronizing.
+        constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+        StreamRange<T> range;
+        range.vertexCount = vertexCount;
+        range.indiceCount = indiceCount;
+        range.baseVertex  = _streamVertexHead;
+        range.firstIndex  = _streamIndiceHead;
+
+        vao.bind();
+        range.vertices = static_cast<T*>(vbo.mapRange(
+            size_t(_streamVertexHead) * sizeof(T), size_t(vertexCount) * sizeof(T), access));
+        if (indiceCount > 0)
+        {
+            range.indices = static_cast<uint32_t*>(ebo.mapRange(
+                size_t(_streamIndiceHead) * sizeof(uint32_t), size_t(indiceCount) * sizeof(uint32_t), access));
+        }
+
+        _streamVertexHead += vertexCount;
+        _streamIndiceHead += indiceCount;
+        _vertexCount = vertexCount;
+        _indiceCount = indiceCount;
+        return range;
+    }
+
+    void unmapStream()
+    {
+        vao.bind();
+        vbo.unmap();
+        if (_indiceCount > 0) { ebo.unmap(); }
+    }
+
+    // Drops the current storage and starts writing at the beginning of a fresh one
+    void orphanStream()
+    {
+        ASSERT(streaming());
+        vao.bind();
+        vbo.allocate(size_t(_streamVertexCapacity) * _streamFrameCount * _layout.sizeBytes(), AccessType::Stream);
+        if (_streamIndiceCapacity > 0)
+        { ebo.allocate(size_t(_streamIndiceCapacity) * _streamFrameCount * sizeof(uint32_t), AccessType::Stream); }
+        _streamVertexHead = 0;
+        _streamIndiceHead = 0;
+
+        // The old storage is the driver's problem now, none of the regions are in use
+        deleteStreamFences();
+        _streamFrame = 0;
+    }
 };
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <TLib/String.hpp>
 #include <TLib/thirdparty/stbi.hpp>
 #include <magic_enum.hpp>
+#include <atomic>
 
 #include "IResource.hpp"
 #include "TextureData.hpp"
@@ -135,6 +136,11 @@ private:
     int32_t            height         = 0;
     TexInternalFormats internalFormat = TexInternalFormats::Unknown;
     Path              _path;
+    uint64_t          _contentId      = 0;
+    bool              _renderTarget   = false;
+
+    // See contentId()
+    static inline std::atomic<uint64_t> nextContentId = 1;
 
     void moveInternals(Texture&& old)
     {
@@ -144,6 +150,9 @@ private:
         height         = std::move(old.height);
         internalFormat = std::move(old.internalFormat);
        _path           = std::move(old._path);
+       _contentId      = old._contentId;
+       _renderTarget   = old._renderTarget;
+        old._contentId = 0;
     }
 
 public:
@@ -176,6 +185,7 @@ public:
         width          = 0;
         height         = 0;
         internalFormat = TexInternalFormats::Unknown;
+       _contentId      = 0;
     }
 
     void create()
@@ -264,6 +274,7 @@ public:
         this->width  = width;
         this->height = height;
         this->internalFormat = internalFormat;
+        _contentId = nextContentId++;
 
         bind();
         setFilter(defaultTexFiltering);
@@ -292,6 +303,7 @@ public:
         int target = GL_TEXTURE_2D;
         int level  = 0;
         int type   = GL_UNSIGNED_BYTE;
+        _contentId = nextContentId++;
 
         bind();
         GL_CHECK(glTexSubImage2D(target, level, xoffset, yoffset, width, height, (GLint)format, type, data));
@@ -324,6 +336,21 @@ public:
     Vector2i getSize() const
     { return Vector2i{ width, height }; }
 
+    // Changes every time the pixels are set with setData() or setSubData(), and is never reused,
+    // even by other textures. 0 if the texture has no data.
+    // Pixels the GPU draws into don't change it, see isRenderTarget().
+    [[nodiscard]]
+    uint64_t contentId() const
+    { return _contentId; }
+
+    // Set for textures attached to a FrameBuffer, their pixels can change without contentId() changing
+    void setRenderTarget(bool renderTarget)
+    { _renderTarget = renderTarget; }
+
+    [[nodiscard]]
+    bool isRenderTarget() const
+    { return _renderTarget; }
+
     // Returns the path passed during loadFromFile()
     // If the texture is empty or the data was passed in without loadFromFile
     // then path().empty() will return true.
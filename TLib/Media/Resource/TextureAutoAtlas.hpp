@@ -0,0 +1,268 @@
+#pragma once
+
+#include <TLib/Media/Resource/Texture.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <TLib/Containers/UnorderedMap.hpp>
+#include <TLib/NonAssignable.hpp>
+#include <TLib/Pointers.hpp>
+#include <TLib/thirdparty/cute.hpp>
+#include <cstring>
+
+struct TextureAutoAtlasSettings
+{
+    int              atlasSize      = 1024; // Width and height of every atlas, clamped to Renderer::getMaxTextureSize()
+    int              maxTextureSize = 128;  // Textures wider or taller than this are never atlased
+    int              lonelyTextures = 16;   // Used textures left out of atlases before a new atlas is built
+    int              framesToDecay  = 600;  // Frames a texture can go unused before it's dropped from its atlas
+    TextureMagFilter filter         = TextureMagFilter::Linear; // Of the atlases, textures filtered differently are left alone
+};
+
+/*
+Copies small textures into shared atlases based on how they're used, with cute_spritebatch.h.
+Textures used in the same frames end up in the same atlas. Atlases whose textures stopped
+being used are rebuilt from the ones still in use, and mostly empty atlases are merged.
+
+    atlas.create(settings);
+
+    // Every flush
+    atlas.use(tex);                             // Every texture that's about to be drawn
+    atlas.update(Renderer::getFrameIndex());
+    if (auto* place = atlas.find(tex))          // Draw with place->atlas and remapped uvs instead
+    { ... }
+
+Textures are read back from the GPU once, the first time they're used with new pixels (see Texture::contentId()),
+and the copy is kept in RAM until the texture decays. Renderer2D::setAutoAtlasEnabled() uses this for its draw calls.
+*/
+struct TextureAutoAtlas : NonCopyable
+{
+public:
+    // Where a texture is in its atlas, uv = uvOffset + uv * uvScale
+    struct Placement
+    {
+        Texture* atlas = nullptr;
+        Vector2f uvOffset;
+        Vector2f uvScale;
+    };
+
+protected:
+    struct Image
+    {
+        Vector<uint8_t> pixels;                   // RGBA, rows from the bottom like the texture
+        Vector2i        size;
+        bool            accepted    = false;      // Filtered like the atlases
+        uint64_t        lastUsed    = 0;          // Frame
+        uint64_t        pushedFlush = UINT64_MAX; // Last flush it was pushed to cute_spritebatch in
+        uint64_t        placedFlush = UINT64_MAX; // Last flush placement was reported in
+        Placement       placement;
+    };
+
+    TextureAutoAtlasSettings              settings;
+    spritebatch_t                         batcher;
+    bool                                  inited      = false;
+    UnorderedMap<uint64_t, Image>         images;          // By Texture::contentId()
+    UnorderedMap<uint64_t, UPtr<Texture>> atlases;         // By cute_spritebatch texture id
+    uint64_t                              nextAtlasId = 1; // 0 means the texture is drawn as is, see generateTexture()
+    uint64_t                              frameIndex  = 0; // Frame of the last update()
+    uint64_t                              flushIndex  = 0; // update() calls
+
+    static Image* findImage(TextureAutoAtlas& self, uint64_t id)
+    {
+        auto it = self.images.find(id);
+        return it != self.images.end() ? &it->second : nullptr;
+    }
+
+    // Callbacks of cute_spritebatch, udata is the TextureAutoAtlas
+
+    static void getPixels(SPRITEBATCH_U64 imageId, void* buffer, int bytesToFill, void* udata)
+    {
+        Image* image = findImage(*static_cast<TextureAutoAtlas*>(udata), imageId);
+
+        // Only images that decayed are dropped, cute_spritebatch shouldn't ask for them. The buffer is cleared already.
+        if (!image) { tlog::warn("TextureAutoAtlas: Pixels of image {} were asked for after it was dropped", imageId); return; }
+
+        ASSERT(size_t(bytesToFill) == image->pixels.size());
+        memcpy(buffer, image->pixels.data(), std::min(image->pixels.size(), size_t(bytesToFill)));
+    }
+
+    // Textures that aren't in an atlas yet (cute_spritebatch's lonely textures) are drawn from the original texture,
+    // so only atlases get a new texture
+    static SPRITEBATCH_U64 generateTexture(void* pixels, int w, int h, void* udata)
+    {
+        auto& self = *static_cast<TextureAutoAtlas*>(udata);
+        if (w != self.batcher.atlas_width_in_pixels || h != self.batcher.atlas_height_in_pixels) { return 0; }
+
+        auto atlas = makeUnique<Texture>();
+        atlas->setData(pixels, w, h, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
+        atlas->setFilter(self.settings.filter == TextureMagFilter::Nearest ? TextureMinFilter::Nearest : TextureMinFilter::Linear,
+                         self.settings.filter);
+
+        const uint64_t id = self.nextAtlasId++;
+        self.atlases[id] = std::move(atlas);
+        return id;
+    }
+
+    static void deleteTexture(SPRITEBATCH_U64 textureId, void* udata)
+    {
+        static_cast<TextureAutoAtlas*>(udata)->atlases.erase(textureId);
+    }
+
+    // Reports where every texture pushed this flush is
+    static void reportBatch(spritebatch_sprite_t* sprites, int count, int texW, int texH, void* udata)
+    {
+        auto&          self    = *static_cast<TextureAutoAtlas*>(udata);
+        const Vector2f atlasSize(float(texW), float(texH));
+
+        for (int i = 0; i < count; i++)
+        {
+            const spritebatch_sprite_t& sprite = sprites[i];
+            Image* image = findImage(self, sprite.image_id);
+            if (!image) { continue; }
+
+            image->placedFlush = self.flushIndex;
+            Placement& place   = image->placement;
+
+            auto atlas  = self.atlases.find(sprite.texture_id);
+            place.atlas = atlas != self.atlases.end() ? atlas->second.get() : nullptr;
+            if (!place.atlas) { continue; }
+
+            // The uvs cover the texture and its 1 texel border, squeezed in by a fraction of a texel.
+            // cute_spritebatch flips them on y, which the texture rows don't need since they're copied as they are.
+            const Vector2f lo(std::round(std::min(sprite.minx, sprite.maxx) * atlasSize.x) + 1.f,
+                              std::round(std::min(sprite.miny, sprite.maxy) * atlasSize.y) + 1.f);
+            const Vector2f hi(std::round(std::max(sprite.minx, sprite.maxx) * atlasSize.x) - 1.f,
+                              std::round(std::max(sprite.miny, sprite.maxy) * atlasSize.y) - 1.f);
+            place.uvOffset = lo / atlasSize;
+            place.uvScale  = (hi - lo) / atlasSize;
+        }
+    }
+
+public:
+    TextureAutoAtlas() = default;
+    ~TextureAutoAtlas() { reset(); }
+
+    [[nodiscard]] inline bool   created()    const { return inited; }
+    [[nodiscard]] inline size_t atlasCount() const { return atlases.size(); }
+    [[nodiscard]] inline const TextureAutoAtlasSettings& getSettings() const { return settings; }
+
+    void create(const TextureAutoAtlasSettings& newSettings = {})
+    {
+        reset();
+        settings           = newSettings;
+        settings.atlasSize = std::min(settings.atlasSize, Renderer::getMaxTextureSize());
+
+        // Textures and their border have to fit an atlas
+        settings.maxTextureSize = std::clamp(settings.maxTextureSize, 1, settings.atlasSize - 2);
+
+        spritebatch_config_t config;
+        spritebatch_set_default_config(&config);
+        config.atlas_width_in_pixels          = settings.atlasSize;
+        config.atlas_height_in_pixels         = settings.atlasSize;
+        config.atlas_use_border_pixels        = 1;
+        config.ticks_to_decay_texture         = std::max(settings.framesToDecay, 1);
+        config.lonely_buffer_count_till_flush = std::max(settings.lonelyTextures, 0);
+        config.batch_callback                 = &reportBatch;
+        config.get_pixels_callback            = &getPixels;
+        config.generate_texture_callback      = &generateTexture;
+        config.delete_texture_callback        = &deleteTexture;
+
+        if (spritebatch_init(&batcher, &config, this) != 0)
+        {
+            tlog::error("TextureAutoAtlas: Failed to create cute_spritebatch");
+            return;
+        }
+        inited = true;
+    }
+
+    void reset()
+    {
+        if (!inited) { return; }
+        spritebatch_term(&batcher);
+        images .clear();
+        atlases.clear();
+        frameIndex = 0;
+        inited     = false;
+    }
+
+    // True if tex can go in an atlas. Its filter is only checked by use().
+    [[nodiscard]] bool accepts(const Texture& tex) const
+    {
+        const Vector2i size = tex.getSize();
+        return inited && tex.contentId() != 0 && !tex.isRenderTarget() &&
+               size.x <= settings.maxTextureSize && size.y <= settings.maxTextureSize;
+    }
+
+    // Tells the atlas tex is about to be drawn. Call it once per texture, for every texture, before update().
+    void use(Texture& tex)
+    {
+        ASSERT(accepts(tex));
+        auto [it, added] = images.try_emplace(tex.contentId());
+        Image& image     = it->second;
+
+        if (added)
+        {
+            image.size = tex.getSize();
+            image.pixels.resize(size_t(image.size.x) * image.size.y * 4);
+
+            tex.bind();
+            GLint mag = 0;
+            GL_CHECK(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &mag));
+            GL_CHECK(glGetnTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, GLsizei(image.pixels.size()), image.pixels.data()));
+            image.accepted = mag == GLint(settings.filter);
+        }
+
+        image.lastUsed = frameIndex;
+        if (!image.accepted || image.pushedFlush == flushIndex) { return; }
+        image.pushedFlush = flushIndex;
+
+        spritebatch_sprite_t sprite = {};
+        sprite.image_id = tex.contentId();
+        sprite.w        = image.size.x;
+        sprite.h        = image.size.y;
+        sprite.sx       = float(image.size.x);
+        sprite.sy       = float(image.size.y);
+        sprite.c        = 1.f;
+        spritebatch_push(&batcher, sprite);
+    }
+
+    // Builds atlases out of the used textures, and finds where the textures used since the last update() are.
+    // Atlases are rebuilt and decay once per frame.
+    void update(uint64_t frame)
+    {
+        ASSERT(inited);
+
+        if (frame != frameIndex)
+        {
+            frameIndex = frame;
+            spritebatch_tick(&batcher);
+            spritebatch_defrag(&batcher);
+            dropDecayedImages();
+        }
+
+        spritebatch_flush(&batcher);
+        ++flushIndex;
+    }
+
+    // Where tex is, nullptr if it isn't in an atlas. Only valid for textures used since the last update().
+    [[nodiscard]] const Placement* find(const Texture& tex) const
+    {
+        auto it = images.find(tex.contentId());
+        if (it == images.end()) { return nullptr; }
+
+        const Image& image = it->second;
+        return image.placedFlush + 1 == flushIndex && image.placement.atlas ? &image.placement : nullptr;
+    }
+
+protected:
+    // cute_spritebatch only asks for pixels of textures used in the last framesToDecay frames,
+    // copies are kept twice as long in case a frame doesn't tick
+    void dropDecayedImages()
+    {
+        const uint64_t keepFrames = uint64_t(settings.framesToDecay) * 2;
+        for (auto it = images.begin(); it != images.end();)
+        {
+            if (frameIndex - it->second.lastUsed > keepFrames) { it = images.erase(it); }
+            else                                               { ++it; }
+        }
+    }
+};
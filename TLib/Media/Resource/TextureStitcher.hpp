@@ -2,7 +2,9 @@
 
 #include <TLib/Media/Resource/Texture.hpp>
 #include <TLib/Media/Resource/Asset.hpp>
+#include <TLib/Media/Resource/AtlasCache.hpp>
 #include <TLib/Containers/UnorderedSet.hpp>
+#include <TLib/Containers/UnorderedMap.hpp>
 #include <TLib/Containers/Deque.hpp>
 #include <TLib/Containers/Hive.hpp>
 #include <TLib/Files.hpp>
@@ -10,6 +12,7 @@
 #include <TLib/NonAssignable.hpp>
 #include <TLib/thirdparty/RectPack2D.hpp>
 #include <TLib/Media/Renderer.hpp>
+#include <TLib/String.hpp>
 
 using namespace rectpack2D;
 
@@ -160,48 +163,121 @@ private:
     }
 };
 
-// Supply and stitch textures one at a time.
-struct TextureStitcherOnline
+/*
+Supply and stitch textures one at a time.
+When a texture doesn't fit in any page, a new page is opened, so loading never fails for lack of space.
+Pages don't move, SubTextures stay valid for as long as the stitcher lives.
+
+    TextureStitcherOnline stitcher;
+    SubTexture sprite = stitcher.load("assets/ship.png"); // Loading a path again returns the same SubTexture
+*/
+struct TextureStitcherOnline : NonCopyable
 {
-    RectPackerOnline packer;
-    Texture          atlas;
+protected:
+    struct Page
+    {
+        RectPackerOnline packer;
+        Texture          atlas;
+    };
+
+    Deque<Page>                      pages;
+    UnorderedMap<String, SubTexture> index; // By indexKey()
+    Vector2i                         pageSize;
+
+    // The same file reached through different relative paths gets the same key, without touching the filesystem
+    static String indexKey(const Path& path)
+    { return fs::absolute(path).lexically_normal().generic_string(); }
+
+    Page& addPage(Vector2i size)
+    {
+        Page& page = pages.emplace_back();
+        page.packer.init(size.x, size.y);
+        page.atlas.create();
+        page.atlas.setData(NULL, size.x, size.y, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
+        page.atlas.setFilter(TextureMinFilter::Nearest, TextureMagFilter::Nearest);
+        page.atlas.setUVMode(UVMode::Repeat);
+        tlog::info("TextureStitcherOnline: Opened page {} ({}x{})", pages.size() - 1, size.x, size.y);
+        return page;
+    }
+
+public:
+    TextureStitcherOnline()  = default;
+    ~TextureStitcherOnline() = default;
 
+    // The texture is nullptr if the file couldn't be loaded
     SubTexture load(const Path& path)
     {
-        // TODO: Resize/New texture when atlas is full
-        if (!atlas.created()) { init(); }
+        if (pages.empty()) { init(); }
 
-        auto existingNode =
-            eastl::find_if(packer.nodes().begin(), packer.nodes().end(),
-                [&path](const RectPackerOnline::Node& v) { return (!v.path.empty()) && fs::equivalent(v.path, path); });
+        const String key = indexKey(path);
+        if (auto it = index.find(key); it != index.end())
+        { return it->second; }
 
-        ASSERT(!existingNode->path.empty());
-        if (existingNode != packer.nodes().end())
+        TextureData data;
+        if (!data.loadFromPath(path))
         {
-            return SubTexture(atlas, Rectf(Vector2f(existingNode->x, existingNode->y), Vector2f(existingNode->width, existingNode->height)));
+            tlog::error("TextureStitcherOnline: Failed to load '{}'", path.string());
+            return SubTexture();
+        }
+
+        const Vector2i size    = data.size();
+        const int      maxSize = Renderer::getMaxTextureSize();
+        if (size.x > maxSize || size.y > maxSize)
+        {
+            tlog::error("TextureStitcherOnline: '{}' is bigger than the biggest texture ({}x{})", path.string(), maxSize, maxSize);
+            return SubTexture();
+        }
+
+        // Newest pages have the most room, try them first
+        Page*                   page = nullptr;
+        RectPackerOnline::Node* node = nullptr;
+        for (auto it = pages.rbegin(); it != pages.rend() && !node; ++it)
+        {
+            page = &*it;
+            node = page->packer.insert(size.x, size.y);
+        }
+
+        if (!node)
+        {
+            // Textures bigger than a page get a page of their own
+            page = &addPage(Vector2i(std::max(pageSize.x, size.x), std::max(pageSize.y, size.y)));
+            node = page->packer.insert(size.x, size.y);
+            ASSERT(node);
         }
 
-        TextureData data;
-        data.loadFromPath(path);
-        auto size  = data.size();
-        auto node  = packer.insert(size.x, size.y);
         node->path = path;
-        atlas.setSubData(data, node->x, node->y);
-        return SubTexture(atlas, Rectf(Vector2f(node->x, node->y), Vector2f(size)));
+        page->atlas.setSubData(data, node->x, node->y);
+
+        SubTexture subTexture(page->atlas, Rectf(Vector2f(node->x, node->y), Vector2f(size)));
+        index[key] = subTexture;
+        return subTexture;
     }
 
+    // nullptr if path wasn't loaded
+    [[nodiscard]] const SubTexture* find(const Path& path) const
+    {
+        auto it = index.find(indexKey(path));
+        return it != index.end() ? &it->second : nullptr;
+    }
+
+    // First page
     auto& getAtlas()
-    { return atlas; }
+    { return pages.front().atlas; }
+
+    [[nodiscard]] inline size_t   pageCount()    const { return pages.size(); }
+    [[nodiscard]] inline size_t   textureCount() const { return index.size(); }
+    [[nodiscard]] inline Texture& getPage(size_t i)    { return pages[i].atlas; }
 
-    void init(int32_t initialSizeX = 1024, int32_t initialSizeY = 1024)
+    // Size of every page, pages are opened as they're needed. Drops everything loaded so far.
+    void init(int32_t pageSizeX = 1024, int32_t pageSizeY = 1024)
     {
-        packer.init(initialSizeX, initialSizeY);
-        atlas.create();
-        atlas.setData(NULL, initialSizeX, initialSizeY, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
-        atlas.setFilter(TextureMinFilter::Nearest, TextureMagFilter::Nearest);
-        atlas.setUVMode(UVMode::Repeat);
-    }
+        pages.clear();
+        index.clear();
 
+        const int maxSize = Renderer::getMaxTextureSize();
+        pageSize = Vector2i(std::min(pageSizeX, maxSize), std::min(pageSizeY, maxSize));
+        addPage(pageSize);
+    }
 };
 
 // Supply all textures up front, then stitch
@@ -235,12 +311,24 @@ public:
         return Asset<SubTexture>(newSprite);
     }
 
-    bool stitch()
+    /*
+    Packs every added texture into the atlas.
+    With a cachePath, the packed atlas is saved there, and later calls load it back with one read and one
+    upload instead, as long as the same textures were added and none of their files changed. See AtlasCache.
+    */
+    bool stitch(const Path& cachePath = Path())
     {
-        tlog::info("Stitching textures...");
         ASSERT(!stitched);
         ASSERT(sprites.size() == texturesToLoad.size());
 
+        if (!cachePath.empty() && loadCache(cachePath))
+        {
+            stitched = true;
+            return true;
+        }
+
+        tlog::info("Stitching textures...");
+
         const auto maxTexSize    = Renderer::getMaxTextureSize();
         const auto discard_step  = -4;
         auto report_successful   = [](rect_type&) { return callback_result::CONTINUE_PACKING; };
@@ -270,25 +358,82 @@ public:
             return false;
         }
 
-        atlas.create();
-        atlas.setData(NULL, resultSize.w, resultSize.h, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
-        atlas.setFilter(TextureMinFilter::NearestMipmapNearest, TextureMagFilter::Nearest);
-        atlas.setUVMode(UVMode::Repeat);
-
+        // Put together on the CPU so it's uploaded once, and can be cached as it is
+        Vector<uint8_t> pixels(size_t(resultSize.w) * resultSize.h * 4, 0);
         for (uint32_t i = 0; i < textures.size(); i++)
         {
             auto& tex  = textures[i];
             auto& rect = rects[i];
-            auto& path = texturesToLoad[i];
-            tlog::info("Stitching texture '{}'", path.string());
-            atlas.setSubData(tex, rect.x, rect.y);
-            auto& sprite  = sprites[i];
-            sprite.rect = Rectf(rect.x, rect.y, rect.w, rect.h);
+            tlog::info("Stitching texture '{}'", texturesToLoad[i].string());
+            if (!tex.valid()) { continue; }
+
+            for (int row = 0; row < rect.h; row++)
+            {
+                memcpy(pixels.data() + (size_t(rect.y + row) * resultSize.w + rect.x) * 4,
+                       tex.ptr() + size_t(row) * rect.w * 4, size_t(rect.w) * 4);
+            }
+            sprites[i].rect = Rectf(rect.x, rect.y, rect.w, rect.h);
         }
 
-        atlas.generateMipmaps();
+        upload(pixels.data(), resultSize.w, resultSize.h);
+
+        if (!cachePath.empty())
+        {
+            Vector<AtlasCache::Source> sources;
+            for (uint32_t i = 0; i < texturesToLoad.size(); i++)
+            {
+                const auto& rect = rects[i];
+                sources.push_back({ cacheName(texturesToLoad[i]), texturesToLoad[i], Recti(rect.x, rect.y, rect.w, rect.h) });
+            }
+
+            if (AtlasCache::write(cachePath, Vector2i(resultSize.w, resultSize.h), pixels.data(), sources))
+            { tlog::info("Saved the stitched textures to '{}'", cachePath.string()); }
+        }
 
         stitched = true;
         return true;
     }
+
+private:
+    // Names in the cache are the paths as they were added, so the cache doesn't depend on the working directory
+    static String cacheName(const Path& path)
+    { return path.lexically_normal().generic_string(); }
+
+    void upload(const void* pixels, int width, int height)
+    {
+        atlas.create();
+        atlas.setData(pixels, width, height, TexPixelFormats::RGBA, TexInternalFormats::RGBA);
+        atlas.setFilter(TextureMinFilter::NearestMipmapNearest, TextureMagFilter::Nearest);
+        atlas.setUVMode(UVMode::Repeat);
+        atlas.generateMipmaps();
+    }
+
+    // False if there's no cache, or it was built from other textures or older files
+    bool loadCache(const Path& cachePath)
+    {
+        AtlasCache cache;
+        if (!cache.load(cachePath)) { return false; }
+
+        if (cache.entryCount() != texturesToLoad.size())
+        {
+            tlog::info("Texture cache '{}' was built from other textures, stitching again", cachePath.string());
+            return false;
+        }
+
+        for (uint32_t i = 0; i < texturesToLoad.size(); i++)
+        {
+            const AtlasCache::Entry* entry = cache.find(cacheName(texturesToLoad[i]));
+            if (!entry || !AtlasCache::isUpToDate(*entry, texturesToLoad[i]))
+            {
+                tlog::info("'{}' changed since '{}' was built, stitching again", texturesToLoad[i].string(), cachePath.string());
+                return false;
+            }
+            sprites[i].rect = Rectf(entry->x, entry->y, entry->w, entry->h);
+        }
+
+        const Vector2i size = cache.getSize();
+        upload(cache.getPixels(), size.x, size.y);
+        tlog::info("Loaded {} stitched textures from '{}'", texturesToLoad.size(), cachePath.string());
+        return true;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <TLib/Media/Renderer2D.hpp>
+#include <TLib/NonAssignable.hpp>
+
+/*
+Records Renderer2D draw calls once and keeps them on the GPU, for geometry that never changes.
+
+    StaticBatch2D background;
+    background.begin();
+    Renderer2D::drawTexture(...); // Any Renderer2D draw calls
+    Renderer2D::drawText(...);
+    background.end();
+
+    // Every frame
+    background.draw();
+
+Draw calls aren't culled while recording, and layers are sorted like Renderer2D::render(true).
+Textures, fonts and shaders used while recording must outlive the batch.
+Lazily loaded glyph pages the batch draws from are pinned until it's recorded again or invalidated, see Font::pinPage().
+Call invalidate(), or record again, when what the batch draws changes.
+*/
+struct StaticBatch2D : NonCopyable
+{
+protected:
+    using PrimVert   = Renderer2D::PrimVert;
+    using WrapVert   = Renderer2D::WrapVert;
+    using IndiceCont = Renderer2D::IndiceCont;
+
+    struct Batch
+    {
+        Shader*    shader       = nullptr;
+        GLDrawMode drawMode     = GLDrawMode::Triangles;
+        bool       wrapped      = false; // Drawn from wrapMesh
+        uint32_t   firstIndex   = 0;
+        uint32_t   indiceCount  = 0;
+        int        textureCount = 0;
+        Array<Texture*, Renderer2D::maxTextureSlots> textures;
+    };
+
+    // A Font::pinPage() this batch holds
+    struct PinnedPage
+    {
+        Font*    font;
+        uint32_t page;
+        uint32_t loadCount;
+    };
+
+    GPUVertexData      mesh;
+    GPUVertexData      wrapMesh; // Sprites with uvs past their texture, see Renderer2D::WrapVert
+    Vector<Batch>      batches;
+    Vector<PinnedPage> pinnedPages;
+    bool               recording = false;
+
+    void unpinPages()
+    {
+        for (const PinnedPage& pin : pinnedPages) { pin.font->unpinPage(pin.page, pin.loadCount); }
+        pinnedPages.clear();
+    }
+
+public:
+    StaticBatch2D()  = default;
+    ~StaticBatch2D() { unpinPages(); }
+
+    [[nodiscard]] inline bool   valid()       const { return !batches.empty(); }
+    [[nodiscard]] inline bool   isRecording() const { return recording; }
+    [[nodiscard]] inline size_t batchCount()  const { return batches.size(); } // Draw calls made by draw()
+
+    // Renderer2D draw calls made until end() are recorded into this batch instead of being queued.
+    // Anything recorded before is replaced.
+    void begin()
+    {
+        ASSERT(!recording);
+        Renderer2D::beginRecording();
+        recording = true;
+    }
+
+    // Builds the batches and uploads them
+    void end()
+    {
+        ASSERT(recording); // Call begin() first
+        recording = false;
+        batches.clear();
+        unpinPages();
+
+        auto& cmds = Renderer2D::drawCmds;
+        if (!cmds.empty())
+        {
+            Renderer2D::sortDrawCmds();
+
+            Renderer2D::StreamCounts counts;
+            Renderer2D::buildBatches(counts);
+            ASSERT(counts.instances == 0); // Instancing is turned off while recording
+
+            Vector<PrimVert> verts(counts.vertices);
+            IndiceCont       inds(counts.indices);
+            Vector<WrapVert> wrapVerts(counts.wrapVertices);
+            IndiceCont       wrapInds(counts.wrapIndices);
+            Renderer2D::writeBatches({ verts.data(), inds.data(), nullptr, wrapVerts.data(), wrapInds.data() }, counts.total());
+
+            for (const Renderer2D::Batch& built : Renderer2D::batches)
+            {
+                Batch& batch       = batches.emplace_back();
+                batch.shader       = cmds[built.cmdBegin].shader;
+                batch.drawMode     = cmds[built.cmdBegin].drawMode;
+                batch.wrapped      = cmds[built.cmdBegin].wrapped;
+                batch.firstIndex   = built.firstIndex;
+                batch.indiceCount  = built.indiceCount;
+                batch.textureCount = built.textureCount;
+                batch.textures     = built.textures;
+            }
+
+            if (!mesh.validLayout()) { mesh.setLayout(Renderer2D::mesh.layout()); }
+            mesh.setData(verts);
+            mesh.setIndices(inds);
+
+            if (!wrapInds.empty())
+            {
+                if (!wrapMesh.validLayout()) { wrapMesh.setLayout(Renderer2D::wrapMesh.layout()); }
+                wrapMesh.setData(wrapVerts);
+                wrapMesh.setIndices(wrapInds);
+            }
+
+            for (const Pair<Font*, uint32_t>& used : Renderer2D::recordedFontPages)
+            {
+                used.first->pinPage(used.second);
+                pinnedPages.push_back({ used.first, used.second, used.first->loadCount() });
+            }
+        }
+
+        Renderer2D::endRecording();
+    }
+
+    // Draws the batch right away with Renderer2D's current view.
+    // Call it between Renderer2D::render() calls to draw it before or after the queued draw calls.
+    void draw()
+    {
+        ASSERT(!recording); // Call end() first
+        if (!valid()) { return; }
+
+        Renderer2D::prepareState();
+        const glm::mat4 projection = Renderer2D::currentView.getMatrix();
+
+        for (Batch& batch : batches)
+        {
+            for (int i = batch.textureCount - 1; i >= 0; i--)
+            { batch.textures[i]->bind(i); }
+
+            Renderer2D::checkCustomShader(*batch.shader);
+            batch.shader->setMat4f("projection", projection);
+
+            RenderState rs;
+            rs.drawMode = batch.drawMode;
+            Renderer::drawRange(*batch.shader, batch.wrapped ? wrapMesh : mesh, batch.indiceCount, batch.firstIndex, 0, rs);
+        }
+    }
+
+    // Frees the GPU data, the batch draws nothing until it's recorded again
+    void invalidate()
+    {
+        ASSERT(!recording);
+        batches.clear();
+        mesh.reset();
+        wrapMesh.reset();
+        unpinPages();
+    }
+};
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <TLib/Types/Types.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+/*
+Turns a polygon with holes into triangles by ear clipping, the way mapbox/earcut does it.
+The outline and its holes can be concave and wind either way, they're fixed up first.
+
+    Tessellator2D tess;
+    Vector<uint32_t> indices;
+    // points is the outline, then each hole. holeStarts is where each hole starts in points.
+    tess.triangulate(points, holeStarts, indices);
+
+Holes are joined to the outline by a bridge, which turns the whole thing into one polygon that's clipped an ear at a time.
+Self intersecting outlines are cut where they cross, or split in two, so they always end up with some triangles.
+Keep a Tessellator2D around, its nodes are reused between calls.
+*/
+struct Tessellator2D
+{
+protected:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    // A corner of the polygon left to clip, a circular list through prev and next
+    struct Node
+    {
+        uint32_t i;       // Into the points
+        float    x, y;
+        uint32_t prev    = none;
+        uint32_t next    = none;
+        bool     steiner = false; // A hole of one point, kept even if it's collinear
+    };
+
+    Vector<Node>     nodes;
+    Vector<uint32_t> holeQueue;
+    Vector<uint32_t>* out = nullptr;
+
+    Node& n(uint32_t node) { return nodes[node]; }
+
+    // Twice the signed area of pqr, negative if it turns counter clockwise with y up
+    float area(uint32_t p, uint32_t q, uint32_t r)
+    {
+        const Node& a = n(p); const Node& b = n(q); const Node& c = n(r);
+        return (b.y - a.y) * (c.x - b.x) - (b.x - a.x) * (c.y - b.y);
+    }
+
+    bool equals(uint32_t a, uint32_t b)
+    { return n(a).x == n(b).x && n(a).y == n(b).y; }
+
+    static bool pointInTriangle(float ax, float ay, float bx, float by, float cx, float cy, float px, float py)
+    {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    uint32_t insertNode(uint32_t i, const Vector2f& p, uint32_t last)
+    {
+        const uint32_t node = uint32_t(nodes.size());
+        nodes.push_back({ i, p.x, p.y });
+        if (last == none)
+        {
+            n(node).prev = node;
+            n(node).next = node;
+        }
+        else
+        {
+            n(node).next = n(last).next;
+            n(node).prev = last;
+            n(n(last).next).prev = node;
+            n(last).next = node;
+        }
+        return node;
+    }
+
+    void removeNode(uint32_t node)
+    {
+        n(n(node).next).prev = n(node).prev;
+        n(n(node).prev).next = n(node).next;
+    }
+
+    // A circular list of points[begin, end), wound clockwise or not. The last node, none if there are no points.
+    uint32_t linkedList(std::span<const Vector2f> points, uint32_t begin, uint32_t end, bool clockwise)
+    {
+        float sum = 0.f;
+        for (uint32_t i = begin, j = end - 1; i < end; j = i++)
+        { sum += (points[j].x - points[i].x) * (points[i].y + points[j].y); }
+
+        uint32_t last = none;
+        if (clockwise == (sum > 0.f))
+        { for (uint32_t i = begin; i < end; i++) { last = insertNode(i, points[i], last); } }
+        else
+        { for (uint32_t i = end; i-- > begin;) { last = insertNode(i, points[i], last); } }
+
+        if (last != none && equals(last, n(last).next))
+        {
+            removeNode(last);
+            last = n(last).next;
+        }
+        return last;
+    }
+
+    // Drops duplicate and collinear points between start and end
+    uint32_t filterPoints(uint32_t start, uint32_t end = none)
+    {
+        if (start == none) { return start; }
+        if (end   == none) { end = start; }
+
+        uint32_t p = start;
+        bool again;
+        do
+        {
+            again = false;
+            if (!n(p).steiner && (equals(p, n(p).next) || area(n(p).prev, p, n(p).next) == 0.f))
+            {
+                removeNode(p);
+                p = end = n(p).prev;
+                if (p == n(p).next) { break; }
+                again = true;
+            }
+            else { p = n(p).next; }
+        } while (again || p != end);
+
+        return end;
+    }
+
+    void emit(uint32_t a, uint32_t b, uint32_t c)
+    { out->insert(out->end(), { n(a).i, n(b).i, n(c).i }); }
+
+    // Clips ears until the polygon is gone. pass 0 clips as is, pass 1 after cutting self intersections,
+    // pass 2 splits what's left in two.
+    void earcutLinked(uint32_t ear, int pass)
+    {
+        if (ear == none) { return; }
+
+        uint32_t stop = ear;
+        while (n(ear).prev != n(ear).next)
+        {
+            const uint32_t prev = n(ear).prev;
+            const uint32_t next = n(ear).next;
+
+            if (isEar(ear))
+            {
+                emit(prev, ear, next);
+                removeNode(ear);
+                ear  = n(next).next;
+                stop = n(next).next;
+                continue;
+            }
+
+            ear = next;
+            if (ear == stop)
+            {
+                if      (pass == 0) { earcutLinked(filterPoints(ear), 1); }
+                else if (pass == 1) { earcutLinked(cureLocalIntersections(filterPoints(ear)), 2); }
+                else                { splitEarcut(ear); }
+                break;
+            }
+        }
+    }
+
+    // No other reflex corner is inside the triangle of ear and its neighbours
+    bool isEar(uint32_t ear)
+    {
+        const uint32_t a = n(ear).prev;
+        const uint32_t c = n(ear).next;
+        if (area(a, ear, c) >= 0.f) { return false; } // Reflex
+
+        const Node& na = n(a); const Node& nb = n(ear); const Node& nc = n(c);
+        const float x0 = std::min({ na.x, nb.x, nc.x }), y0 = std::min({ na.y, nb.y, nc.y });
+        const float x1 = std::max({ na.x, nb.x, nc.x }), y1 = std::max({ na.y, nb.y, nc.y });
+
+        for (uint32_t p = nc.next; p != a; p = n(p).next)
+        {
+            const Node& np = n(p);
+            if (np.x >= x0 && np.x <= x1 && np.y >= y0 && np.y <= y1 &&
+                pointInTriangle(na.x, na.y, nb.x, nb.y, nc.x, nc.y, np.x, np.y) &&
+                area(np.prev, p, np.next) >= 0.f)
+            { return false; }
+        }
+        return true;
+    }
+
+    // Clips the triangle over each small self intersection (two edges crossing one corner apart)
+    uint32_t cureLocalIntersections(uint32_t start)
+    {
+        uint32_t p = start;
+        do
+        {
+            const uint32_t a = n(p).prev;
+            const uint32_t b = n(n(p).next).next;
+
+            if (!equals(a, b) && intersects(a, p, n(p).next, b) && locallyInside(a, b) && locallyInside(b, a))
+            {
+                emit(a, p, b);
+                removeNode(p);
+                removeNode(n(p).next);
+                p = start = b;
+            }
+            p = n(p).next;
+        } while (p != start);
+
+        return filterPoints(p);
+    }
+
+    // Splits the polygon in two along a diagonal inside it, and clips both
+    void splitEarcut(uint32_t start)
+    {
+        uint32_t a = start;
+        do
+        {
+            for (uint32_t b = n(n(a).next).next; b != n(a).prev; b = n(b).next)
+            {
+                if (n(a).i != n(b).i && isValidDiagonal(a, b))
+                {
+                    uint32_t c = splitPolygon(a, b);
+                    a = filterPoints(a, n(a).next);
+                    c = filterPoints(c, n(c).next);
+                    earcutLinked(a, 0);
+                    earcutLinked(c, 0);
+                    return;
+                }
+            }
+            a = n(a).next;
+        } while (a != start);
+    }
+
+    // Joins each hole to the outline, leftmost holes first
+    uint32_t eliminateHoles(std::span<const Vector2f> points, std::span<const uint32_t> holeStarts, uint32_t outer)
+    {
+        holeQueue.clear();
+        for (size_t h = 0; h < holeStarts.size(); h++)
+        {
+            const uint32_t begin = holeStarts[h];
+            const uint32_t end   = h + 1 < holeStarts.size() ? holeStarts[h + 1] : uint32_t(points.size());
+            if (begin >= end) { continue; }
+
+            const uint32_t list = linkedList(points, begin, end, false);
+            if (list == none) { continue; }
+            if (list == n(list).next) { n(list).steiner = true; }
+            holeQueue.push_back(getLeftmost(list));
+        }
+
+        std::sort(holeQueue.begin(), holeQueue.end(), [&](uint32_t a, uint32_t b) { return n(a).x < n(b).x; });
+
+        for (const uint32_t hole : holeQueue)
+        { outer = eliminateHole(hole, outer); }
+        return outer;
+    }
+
+    uint32_t eliminateHole(uint32_t hole, uint32_t outer)
+    {
+        const uint32_t bridge = findHoleBridge(hole, outer);
+        if (bridge == none) { return outer; }
+
+        const uint32_t bridgeReverse = splitPolygon(bridge, hole);
+        filterPoints(bridgeReverse, n(bridgeReverse).next);
+        return filterPoints(bridge, n(bridge).next);
+    }
+
+    // The corner of the outline a ray going left from hole hits first, or that's visible from hole (David Eberly's method)
+    uint32_t findHoleBridge(uint32_t hole, uint32_t outer)
+    {
+        const float hx = n(hole).x;
+        const float hy = n(hole).y;
+        float       qx = -INFINITY;
+        uint32_t    m  = none;
+
+        uint32_t p = outer;
+        do
+        {
+            const Node& np = n(p);
+            const Node& nn = n(np.next);
+            if (hy <= np.y && hy >= nn.y && nn.y != np.y)
+            {
+                const float x = np.x + (hy - np.y) * (nn.x - np.x) / (nn.y - np.y);
+                if (x <= hx && x > qx)
+                {
+                    qx = x;
+                    m  = np.x < nn.x ? p : np.next;
+                    if (x == hx) { return m; } // The hole touches the outline
+                }
+            }
+            p = np.next;
+        } while (p != outer);
+
+        if (m == none) { return none; }
+
+        // Reflex corners inside the triangle of the hole, the hit and m can block the view, take the one closest to the ray
+        const uint32_t stop   = m;
+        const float    mx     = n(m).x;
+        const float    my     = n(m).y;
+        float          tanMin = INFINITY;
+
+        p = m;
+        do
+        {
+            const Node& np = n(p);
+            if (hx >= np.x && np.x >= mx && hx != np.x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, np.x, np.y))
+            {
+                const float tan = std::abs(hy - np.y) / (hx - np.x);
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (np.x > n(m).x || (np.x == n(m).x && sectorContainsSector(m, p))))))
+                {
+                    m      = p;
+                    tanMin = tan;
+                }
+            }
+            p = np.next;
+        } while (p != stop);
+
+        return m;
+    }
+
+    bool sectorContainsSector(uint32_t m, uint32_t p)
+    { return area(n(m).prev, m, n(p).prev) < 0.f && area(n(p).next, m, n(m).next) < 0.f; }
+
+    uint32_t getLeftmost(uint32_t start)
+    {
+        uint32_t p        = start;
+        uint32_t leftmost = start;
+        do
+        {
+            if (n(p).x < n(leftmost).x || (n(p).x == n(leftmost).x && n(p).y < n(leftmost).y)) { leftmost = p; }
+            p = n(p).next;
+        } while (p != start);
+        return leftmost;
+    }
+
+    bool isValidDiagonal(uint32_t a, uint32_t b)
+    {
+        if (n(n(a).next).i == n(b).i || n(n(a).prev).i == n(b).i || intersectsPolygon(a, b)) { return false; }
+
+        // Inside the polygon and not collinear with the corners, or the same point where two parts touch
+        return (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+                (area(n(a).prev, a, n(b).prev) != 0.f || area(a, n(b).prev, b) != 0.f)) ||
+               (equals(a, b) && area(n(a).prev, a, n(a).next) > 0.f && area(n(b).prev, b, n(b).next) > 0.f);
+    }
+
+    static int sign(float v)
+    { return v > 0.f ? 1 : v < 0.f ? -1 : 0; }
+
+    // q is on segment pr, given the three are collinear
+    bool onSegment(uint32_t p, uint32_t q, uint32_t r)
+    {
+        return n(q).x <= std::max(n(p).x, n(r).x) && n(q).x >= std::min(n(p).x, n(r).x) &&
+               n(q).y <= std::max(n(p).y, n(r).y) && n(q).y >= std::min(n(p).y, n(r).y);
+    }
+
+    bool intersects(uint32_t p1, uint32_t q1, uint32_t p2, uint32_t q2)
+    {
+        const int o1 = sign(area(p1, q1, p2));
+        const int o2 = sign(area(p1, q1, q2));
+        const int o3 = sign(area(p2, q2, p1));
+        const int o4 = sign(area(p2, q2, q1));
+
+        if (o1 != o2 && o3 != o4)                { return true; }
+        if (o1 == 0 && onSegment(p1, p2, q1)) { return true; }
+        if (o2 == 0 && onSegment(p1, q2, q1)) { return true; }
+        if (o3 == 0 && onSegment(p2, p1, q2)) { return true; }
+        if (o4 == 0 && onSegment(p2, q1, q2)) { return true; }
+        return false;
+    }
+
+    // Diagonal ab crosses an edge of the polygon
+    bool intersectsPolygon(uint32_t a, uint32_t b)
+    {
+        uint32_t p = a;
+        do
+        {
+            const uint32_t next = n(p).next;
+            if (n(p).i != n(a).i && n(next).i != n(a).i && n(p).i != n(b).i && n(next).i != n(b).i &&
+                intersects(p, next, a, b))
+            { return true; }
+            p = next;
+        } while (p != a);
+        return false;
+    }
+
+    // Diagonal ab starts off inside the polygon at a
+    bool locallyInside(uint32_t a, uint32_t b)
+    {
+        return area(n(a).prev, a, n(a).next) < 0.f ?
+            area(a, b, n(a).next) >= 0.f && area(a, n(a).prev, b) >= 0.f :
+            area(a, b, n(a).prev) <  0.f || area(a, n(a).next, b) <  0.f;
+    }
+
+    // The middle of diagonal ab is inside the polygon
+    bool middleInside(uint32_t a, uint32_t b)
+    {
+        const float px     = (n(a).x + n(b).x) / 2.f;
+        const float py     = (n(a).y + n(b).y) / 2.f;
+        bool        inside = false;
+
+        uint32_t p = a;
+        do
+        {
+            const Node& np = n(p);
+            const Node& nn = n(np.next);
+            if ((np.y > py) != (nn.y > py) && nn.y != np.y &&
+                px < (nn.x - np.x) * (py - np.y) / (nn.y - np.y) + np.x)
+            { inside = !inside; }
+            p = np.next;
+        } while (p != a);
+        return inside;
+    }
+
+    // Links a to b with a diagonal, splitting the polygon in two. If they're in different polygons (a hole), it joins them.
+    // Returns the copy of b, in the second polygon.
+    uint32_t splitPolygon(uint32_t a, uint32_t b)
+    {
+        const uint32_t a2 = uint32_t(nodes.size());
+        const uint32_t b2 = a2 + 1;
+        nodes.push_back({ n(a).i, n(a).x, n(a).y });
+        nodes.push_back({ n(b).i, n(b).x, n(b).y });
+
+        const uint32_t an = n(a).next;
+        const uint32_t bp = n(b).prev;
+
+        n(a) .next = b;  n(b) .prev = a;
+        n(a2).next = an; n(an).prev = a2;
+        n(b2).next = a2; n(a2).prev = b2;
+        n(bp).next = b2; n(b2).prev = bp;
+        return b2;
+    }
+
+public:
+    /*
+    Appends 3 indices into points for each triangle, returns how many triangles were added.
+    points holds the outline and then every hole, each hole starts at its entry of holeStarts.
+    Rings with fewer than 3 distinct points add nothing.
+    */
+    size_t triangulate(std::span<const Vector2f> points,
+                       std::span<const uint32_t> holeStarts,
+                       Vector<uint32_t>&         indices)
+    {
+        const size_t   first    = indices.size();
+        const uint32_t outerEnd = holeStarts.empty() ? uint32_t(points.size()) : std::min(holeStarts[0], uint32_t(points.size()));
+        if (outerEnd < 3) { return 0; }
+
+        nodes.clear();
+        nodes.reserve(points.size() * 3 / 2 + holeStarts.size() * 2);
+        out = &indices;
+
+        uint32_t outer = linkedList(points, 0, outerEnd, true);
+        if (outer != none && n(outer).next != n(outer).prev)
+        {
+            if (!holeStarts.empty()) { outer = eliminateHoles(points, holeStarts, outer); }
+            earcutLinked(outer, 0);
+        }
+
+        out = nullptr;
+        return (indices.size() - first) / 3;
+    }
+};
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <TLib/Media/Renderer2D.hpp>
+#include <TLib/Media/StaticBatch2D.hpp>
+#include <TLib/Media/Resource/Texture.hpp>
+#include <TLib/Containers/Vector.hpp>
+#include <TLib/NonAssignable.hpp>
+#include <TLib/Pointers.hpp>
+#include <TLib/String.hpp>
+#include <TLib/Files.hpp>
+#include <TLib/thirdparty/cute.hpp>
+
+/*
+A Tiled (https://www.mapeditor.org/) map, loaded from its JSON export with cute_tiled.
+
+    TileMap2D map;
+    map.loadFromFile("assets/level.json");
+
+    // Every frame
+    map.draw();
+
+Every tile layer is split in chunks of chunkSize x chunkSize tiles, and each chunk is recorded into
+a StaticBatch2D once, so a frame costs one draw call per visible chunk and tileset instead of one per tile.
+draw() only draws the chunks that overlap the current Renderer2D view.
+
+Tile (x, y) of the map covers the world rect (x * tileWidth, (mapHeight - 1 - y) * tileHeight, tileWidth, tileHeight),
+so the map looks like it does in Tiled, with its bottom left corner on the origin.
+Only orthogonal maps with CSV tile data and tilesets made of a single image are supported.
+Flipped and rotated tiles are drawn like in Tiled. Object and image layers are skipped.
+*/
+struct TileMap2D : NonCopyable
+{
+    static constexpr int defaultChunkSize = 32;
+
+protected:
+    struct Tileset
+    {
+        int           firstGid   = 1;
+        int           tileCount  = 0;
+        int           columns    = 1;
+        Vector2i      tileSize;
+        Vector2i      tileOffset;
+        int           margin     = 0;
+        int           spacing    = 0;
+        UPtr<Texture> texture;
+    };
+
+    struct Chunk
+    {
+        Rectf               bounds; // Of the tiles drawn by the chunk, they can be bigger than a grid cell
+        UPtr<StaticBatch2D> batch;
+    };
+
+    struct Layer
+    {
+        String           name;
+        bool             visible = true;
+        Vector<uint32_t> tiles;     // GIDs with the flip flags, 0 for none. See getTile()
+        Vector<Chunk>    chunks;
+    };
+
+    Vector<Tileset> tilesets; // Sorted by firstGid
+    Vector<Layer>   layers;
+    Vector2i        mapSize;
+    Vector2i        tileSize;
+    int             chunkSize   = defaultChunkSize;
+    size_t          drawnChunks = 0;
+
+    // Scratch space for building a chunk, one list per tileset
+    Vector<Vector<SpriteInstance>> chunkSprites;
+
+    // Tileset a GID without flags belongs to, nullptr if none
+    Tileset* findTileset(int gid)
+    {
+        for (size_t i = tilesets.size(); i-- > 0;)
+        {
+            Tileset& ts = tilesets[i];
+            if (gid >= ts.firstGid) { return gid < ts.firstGid + ts.tileCount ? &ts : nullptr; }
+        }
+        return nullptr;
+    }
+
+    // Tiled applies the diagonal flip first, then horizontal, then vertical.
+    // With y up a diagonal flip is a 90 degree turn of a sprite mirrored on x, the other flips then swap axes.
+    void addTile(uint32_t gidWithFlags, int x, int y, const Vector2f& offset, float opacity, Rectf& bounds, bool& empty)
+    {
+        const int gid = cute_tiled_unset_flags(int(gidWithFlags));
+        Tileset*  ts  = findTileset(gid);
+        if (!ts) { return; }
+
+        int flipH, flipV, flipD;
+        cute_tiled_get_flags(int(gidWithFlags), &flipH, &flipV, &flipD);
+        const float fx = flipH ? -1.f : 1.f;
+        const float fy = flipV ? -1.f : 1.f;
+
+        const int local = gid - ts->firstGid;
+        const int col   = local % ts->columns;
+        const int row   = local / ts->columns;
+
+        // Tiled counts rows down from the top, the world and textures count up from the bottom.
+        // Tiles bigger than the grid stick out of the top of their cell, like in Tiled.
+        const Vector2f tsSize(ts->tileSize);
+        const Rectf dst(offset.x + float(x * tileSize.x + ts->tileOffset.x),
+                        offset.y + float((mapSize.y - 1 - y) * tileSize.y - ts->tileOffset.y),
+                        tsSize.x, tsSize.y);
+
+        const int imageHeight = ts->texture->getSize().y;
+        SpriteInstance& sprite = chunkSprites[ts - tilesets.data()].emplace_back();
+        sprite.pos     = dst.getPos() + tsSize / 2.f;
+        sprite.srcrect = Rectf(float(ts->margin + col * (ts->tileSize.x + ts->spacing)),
+                               float(imageHeight - ts->margin - row * (ts->tileSize.y + ts->spacing) - ts->tileSize.y),
+                               tsSize.x, tsSize.y);
+        sprite.color   = { 1.f, 1.f, 1.f, opacity };
+
+        if (flipD)
+        {
+            sprite.size     = { -fy * tsSize.x, fx * tsSize.y };
+            sprite.rotation = glm::half_pi<float>();
+        }
+        else
+        { sprite.size = { fx * tsSize.x, fy * tsSize.y }; }
+
+        if (empty) { bounds = dst; empty = false; }
+        else
+        {
+            const float left   = std::min(bounds.x, dst.x);
+            const float top    = std::min(bounds.y, dst.y);
+            const float right  = std::max(bounds.getRight(),  dst.getRight());
+            const float bottom = std::max(bounds.getBottom(), dst.getBottom());
+            bounds = Rectf(left, top, right - left, bottom - top);
+        }
+    }
+
+    // Records the tiles of layer in chunks
+    void buildChunks(Layer& layer, const Vector2f& offset, float opacity)
+    {
+        const int chunksX = (mapSize.x + chunkSize - 1) / chunkSize;
+        const int chunksY = (mapSize.y + chunkSize - 1) / chunkSize;
+        chunkSprites.resize(tilesets.size());
+
+        for (int cy = 0; cy < chunksY; cy++)
+        {
+            for (int cx = 0; cx < chunksX; cx++)
+            {
+                for (auto& sprites : chunkSprites) { sprites.clear(); }
+
+                Rectf bounds;
+                bool  empty = true;
+                const int xEnd = std::min(mapSize.x, (cx + 1) * chunkSize);
+                const int yEnd = std::min(mapSize.y, (cy + 1) * chunkSize);
+                for (int y = cy * chunkSize; y < yEnd; y++)
+                {
+                    for (int x = cx * chunkSize; x < xEnd; x++)
+                    {
+                        const uint32_t gid = layer.tiles[size_t(y) * mapSize.x + x];
+                        if (gid != 0) { addTile(gid, x, y, offset, opacity, bounds, empty); }
+                    }
+                }
+                if (empty) { continue; }
+
+                Chunk& chunk = layer.chunks.emplace_back();
+                chunk.bounds = bounds;
+                chunk.batch  = makeUnique<StaticBatch2D>();
+
+                // One bulk draw per tileset, nothing is culled while recording
+                chunk.batch->begin();
+                for (size_t i = 0; i < tilesets.size(); i++)
+                {
+                    if (chunkSprites[i].empty()) { continue; }
+                    Renderer2D::drawTextures(*tilesets[i].texture, chunkSprites[i]);
+                }
+                chunk.batch->end();
+            }
+        }
+    }
+
+    // Tile layers of group layers are added too, with the offset, opacity and visibility of the group
+    bool addLayers(const cute_tiled_layer_t* layer, const Vector2f& offset, float opacity, bool visible)
+    {
+        for (; layer; layer = layer->next)
+        {
+            const Vector2f layerOffset  = offset + Vector2f(layer->offsetx, -layer->offsety); // Tiled's y points down
+            const float    layerOpacity = opacity * layer->opacity;
+            const bool     layerVisible = visible && layer->visible;
+            const String   type         = layer->type.ptr ? layer->type.ptr : "";
+
+            if (type == "group")
+            {
+                if (!addLayers(layer->layers, layerOffset, layerOpacity, layerVisible)) { return false; }
+                continue;
+            }
+            if (type != "tilelayer") { continue; }
+
+            if (!layer->data || layer->data_count != mapSize.x * mapSize.y)
+            {
+                tlog::error("TileMap2D: Layer '{}' has no usable tile data, only CSV data of fixed size maps is supported",
+                            layer->name.ptr ? layer->name.ptr : "");
+                return false;
+            }
+
+            Layer& l  = layers.emplace_back();
+            l.name    = layer->name.ptr ? layer->name.ptr : "";
+            l.visible = layerVisible;
+            l.tiles.assign(reinterpret_cast<const uint32_t*>(layer->data),
+                           reinterpret_cast<const uint32_t*>(layer->data) + layer->data_count);
+            buildChunks(l, layerOffset, layerOpacity);
+        }
+        return true;
+    }
+
+    bool load(cute_tiled_map_t* map, const Path& imageDir, int newChunkSize)
+    {
+        reset();
+        if (!map)
+        {
+            tlog::error("TileMap2D: Failed to parse the map: {}", cute_tiled_error_reason ? cute_tiled_error_reason : "");
+            return false;
+        }
+
+        ASSERT(newChunkSize > 0);
+        chunkSize = newChunkSize;
+        mapSize   = { map->width,     map->height     };
+        tileSize  = { map->tilewidth, map->tileheight };
+
+        bool ok = true;
+        if (map->orientation.ptr && String(map->orientation.ptr) != "orthogonal")
+        { tlog::warn("TileMap2D: Only orthogonal maps are supported, '{}' will be drawn as one", map->orientation.ptr); }
+
+        for (const cute_tiled_tileset_t* ts = map->tilesets; ts && ok; ts = ts->next)
+        {
+            if (!ts->image.ptr)
+            {
+                tlog::warn("TileMap2D: Tileset '{}' isn't made of a single image, skipped", ts->name.ptr ? ts->name.ptr : "");
+                continue;
+            }
+
+            Tileset& tileset   = tilesets.emplace_back();
+            tileset.firstGid   = ts->firstgid;
+            tileset.tileCount  = ts->tilecount;
+            tileset.columns    = std::max(1, ts->columns);
+            tileset.tileSize   = { ts->tilewidth,    ts->tileheight   };
+            tileset.tileOffset = { ts->tileoffset_x, ts->tileoffset_y };
+            tileset.margin     = ts->margin;
+            tileset.spacing    = ts->spacing;
+            tileset.texture    = makeUnique<Texture>();
+            ok = tileset.texture->loadFromFile(imageDir / ts->image.ptr);
+        }
+
+        std::sort(tilesets.begin(), tilesets.end(),
+            [](const Tileset& a, const Tileset& b) { return a.firstGid < b.firstGid; });
+
+        if (ok) { ok = addLayers(map->layers, Vector2f(0.f, 0.f), 1.f, true); }
+        cute_tiled_free_map(map);
+
+        if (!ok) { reset(); return false; }
+
+        size_t chunkCount = 0;
+        for (const Layer& layer : layers) { chunkCount += layer.chunks.size(); }
+        tlog::info("TileMap2D: Loaded {}x{} tiles, {} layers, {} chunks", mapSize.x, mapSize.y, layers.size(), chunkCount);
+        return true;
+    }
+
+public:
+    TileMap2D()  = default;
+    ~TileMap2D() = default;
+
+    [[nodiscard]] inline bool     valid()       const { return !layers.empty(); }
+    [[nodiscard]] inline Vector2i getMapSize()  const { return mapSize;  } // In tiles
+    [[nodiscard]] inline Vector2i getTileSize() const { return tileSize; }
+    [[nodiscard]] inline size_t   layerCount()  const { return layers.size(); }
+    [[nodiscard]] inline size_t   drawnChunkCount() const { return drawnChunks; } // By the last draw()
+
+    // chunkSize is in tiles. Tileset images are loaded relative to the map file.
+    bool loadFromFile(const Path& path, int newChunkSize = defaultChunkSize)
+    {
+        const String data = readFile(path);
+        if (data.empty())
+        {
+            tlog::error("TileMap2D: Failed to read map file ('{}')", path.string());
+            reset();
+            return false;
+        }
+        return loadFromMemory(data.data(), data.size(), path.parent_path(), newChunkSize);
+    }
+
+    // data is the JSON of the map, tileset images are loaded relative to imageDir
+    bool loadFromMemory(const void* data, size_t size, const Path& imageDir = Path(), int newChunkSize = defaultChunkSize)
+    {
+        return load(cute_tiled_load_map_from_memory(data, int(size), nullptr), imageDir, newChunkSize);
+    }
+
+    void reset()
+    {
+        layers  .clear();
+        tilesets.clear();
+        mapSize     = { 0, 0 };
+        tileSize    = { 0, 0 };
+        drawnChunks = 0;
+    }
+
+    [[nodiscard]] const String& getLayerName(size_t layer) const
+    { return layers[layer].name; }
+
+    [[nodiscard]] bool isLayerVisible(size_t layer) const
+    { return layers[layer].visible; }
+
+    void setLayerVisible(size_t layer, bool visible)
+    { layers[layer].visible = visible; }
+
+    // Index of the layer called name, -1 if there's none
+    [[nodiscard]] int findLayer(const String& name) const
+    {
+        for (size_t i = 0; i < layers.size(); i++)
+        { if (layers[i].name == name) { return int(i); } }
+        return -1;
+    }
+
+    // GID of the tile at (x, y), without the flip flags. 0 if there's no tile.
+    [[nodiscard]] int getTile(size_t layer, int x, int y) const
+    {
+        ASSERT(x >= 0 && y >= 0 && x < mapSize.x && y < mapSize.y);
+        return cute_tiled_unset_flags(int(layers[layer].tiles[size_t(y) * mapSize.x + x]));
+    }
+
+    // Draws the visible layers right away, in map order. See StaticBatch2D::draw()
+    void draw()
+    {
+        drawnChunks = 0;
+        for (size_t i = 0; i < layers.size(); i++)
+        { if (layers[i].visible) { drawLayer(i); } }
+    }
+
+    // Draws the chunks of one layer that overlap the current Renderer2D view, even if the layer is hidden
+    void drawLayer(size_t layer)
+    {
+        for (Chunk& chunk : layers[layer].chunks)
+        {
+            if (!Renderer2D::isVisible(chunk.bounds)) { continue; }
+            chunk.batch->draw();
+            ++drawnChunks;
+        }
+    }
+};
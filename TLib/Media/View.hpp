@@ -23,6 +23,23 @@ struct View
         return center - (size / zoom / 2.f);
     }
 
+    // The area of the world that's visible through this view
+    Rectf getBounds() const
+    {
+        // Negative sizes/zooms flip the view, they don't change the area
+        const Vector2f scaled      = size / zoom;
+        const Vector2f visibleSize = { std::abs(scaled.x), std::abs(scaled.y) };
+        if (rotation == 0.f)
+        { return Rectf(center - visibleSize / 2.f, visibleSize); }
+
+        // Bounding box of the rotated view
+        const float s = std::abs(std::sin(rotation));
+        const float c = std::abs(std::cos(rotation));
+        const Vector2f rotatedSize = { visibleSize.x * c + visibleSize.y * s,
+                                       visibleSize.x * s + visibleSize.y * c };
+        return Rectf(center - rotatedSize / 2.f, rotatedSize);
+    }
+
     glm::mat4 getMatrix() const
     {
         Vector2f halfSize = size/2.f;
@@ -0,0 +1,276 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// Define TLIB_NO_SIMD to force the plain C++ fallback
+#if !defined(TLIB_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define TLIB_SIMD_SSE
+    #include <emmintrin.h>
+#elif !defined(TLIB_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+    #define TLIB_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace simd
+{
+    /**
+     * 4 floats that are operated on together, using SSE2 or NEON when available.
+     * Comparisons return masks (all bits set in lanes where they're true) for select() and bits().
+     */
+    struct Float4
+    {
+    #if defined(TLIB_SIMD_SSE)
+        __m128 v;
+    #elif defined(TLIB_SIMD_NEON)
+        float32x4_t v;
+    #else
+        float v[4];
+    #endif
+
+        // p doesn't need to be aligned
+        static inline Float4 load(const float* p)
+        {
+        #if defined(TLIB_SIMD_SSE)
+            return { _mm_loadu_ps(p) };
+        #elif defined(TLIB_SIMD_NEON)
+            return { vld1q_f32(p) };
+        #else
+            return { { p[0], p[1], p[2], p[3] } };
+        #endif
+        }
+
+        static inline Float4 set1(float x)
+        {
+        #if defined(TLIB_SIMD_SSE)
+            return { _mm_set1_ps(x) };
+        #elif defined(TLIB_SIMD_NEON)
+            return { vdupq_n_f32(x) };
+        #else
+            return { { x, x, x, x } };
+        #endif
+        }
+
+        static inline Float4 set(float x, float y, float z, float w)
+        {
+        #if defined(TLIB_SIMD_SSE)
+            return { _mm_setr_ps(x, y, z, w) };
+        #elif defined(TLIB_SIMD_NEON)
+            const float values[4] = { x, y, z, w };
+            return { vld1q_f32(values) };
+        #else
+            return { { x, y, z, w } };
+        #endif
+        }
+
+        // p doesn't need to be aligned
+        inline void store(float* p) const
+        {
+        #if defined(TLIB_SIMD_SSE)
+            _mm_storeu_ps(p, v);
+        #elif defined(TLIB_SIMD_NEON)
+            vst1q_f32(p, v);
+        #else
+            p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3];
+        #endif
+        }
+    };
+
+#if !defined(TLIB_SIMD_SSE) && !defined(TLIB_SIMD_NEON)
+    namespace detail
+    {
+        template <typename Op>
+        inline Float4 map(const Float4& a, const Float4& b, Op op)
+        { return { { op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]) } }; }
+
+        inline float maskOf(bool b)
+        { return std::bit_cast<float>(b ? 0xFFFFFFFFu : 0u); }
+
+        inline uint32_t bitsOf(float f)
+        { return std::bit_cast<uint32_t>(f); }
+    }
+#endif
+
+    inline Float4 operator+(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_add_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vaddq_f32(a.v, b.v) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return x + y; });
+    #endif
+    }
+
+    inline Float4 operator-(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_sub_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vsubq_f32(a.v, b.v) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return x - y; });
+    #endif
+    }
+
+    inline Float4 operator*(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_mul_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vmulq_f32(a.v, b.v) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return x * y; });
+    #endif
+    }
+
+    inline Float4 min(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_min_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vminq_f32(a.v, b.v) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return x < y ? x : y; });
+    #endif
+    }
+
+    inline Float4 max(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_max_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vmaxq_f32(a.v, b.v) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return x > y ? x : y; });
+    #endif
+    }
+
+    inline Float4 operator<=(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_cmple_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vreinterpretq_f32_u32(vcleq_f32(a.v, b.v)) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return detail::maskOf(x <= y); });
+    #endif
+    }
+
+    inline Float4 operator>=(const Float4& a, const Float4& b)
+    { return b <= a; }
+
+    inline Float4 operator==(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_cmpeq_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vreinterpretq_f32_u32(vceqq_f32(a.v, b.v)) };
+    #else
+        return detail::map(a, b, [](float x, float y) { return detail::maskOf(x == y); });
+    #endif
+    }
+
+    // Bitwise and, used to combine masks
+    inline Float4 operator&(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_and_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+    #else
+        return detail::map(a, b, [](float x, float y)
+            { return std::bit_cast<float>(detail::bitsOf(x) & detail::bitsOf(y)); });
+    #endif
+    }
+
+    // Bitwise or, used to combine masks
+    inline Float4 operator|(const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_or_ps(a.v, b.v) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+    #else
+        return detail::map(a, b, [](float x, float y)
+            { return std::bit_cast<float>(detail::bitsOf(x) | detail::bitsOf(y)); });
+    #endif
+    }
+
+    // Lanes of a where mask is set, lanes of b elsewhere
+    inline Float4 select(const Float4& mask, const Float4& a, const Float4& b)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+    #elif defined(TLIB_SIMD_NEON)
+        return { vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) };
+    #else
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+        { r.v[i] = detail::bitsOf(mask.v[i]) ? a.v[i] : b.v[i]; }
+        return r;
+    #endif
+    }
+
+    // Bit i is set if lane i of mask is set
+    inline int bits(const Float4& mask)
+    {
+    #if defined(TLIB_SIMD_SSE)
+        return _mm_movemask_ps(mask.v);
+    #else
+        float lanes[4];
+        mask.store(lanes);
+        int r = 0;
+        for (int i = 0; i < 4; i++)
+        { r |= (std::bit_cast<uint32_t>(lanes[i]) >> 31) << i; }
+        return r;
+    #endif
+    }
+
+    // Rounds to the nearest integer, for |x| < 2^22
+    inline Float4 round(const Float4& x)
+    {
+        const Float4 magic = Float4::set1(12582912.f); // 1.5 * 2^23
+        return (x + magic) - magic;
+    }
+
+    /**
+     * sin and cos of 4 angles at once, in radians.
+     * Cephes style: reduced to [-pi/4, pi/4] by quadrant, then minimax polynomials.
+     * Max error is around 1e-7 for angles up to a few thousand radians.
+     */
+    inline void sincos(const Float4& x, Float4& outSin, Float4& outCos)
+    {
+        // x = j * pi/2 + r, pi/2 split in 3 parts so r stays exact
+        const Float4 j = round(x * Float4::set1(0.636619772367581343f)); // 2/pi
+        Float4 r = x - j * Float4::set1(1.5703125f);
+        r = r - j * Float4::set1(4.837512969970703125e-4f);
+        r = r - j * Float4::set1(7.54978995489188216e-8f);
+
+        const Float4 r2 = r * r;
+
+        Float4 s = Float4::set1(-1.9515295891e-4f);
+        s = s * r2 + Float4::set1(8.3321608736e-3f);
+        s = s * r2 + Float4::set1(-1.6666654611e-1f);
+        s = s * r2 * r + r;
+
+        Float4 c = Float4::set1(2.443315711809948e-5f);
+        c = c * r2 + Float4::set1(-1.388731625493765e-3f);
+        c = c * r2 + Float4::set1(4.166664568298827e-2f);
+        c = c * r2 * r2 - r2 * Float4::set1(0.5f) + Float4::set1(1.f);
+
+        // Quadrant, j mod 4
+        const Float4 q = j - round(j * Float4::set1(0.25f) - Float4::set1(0.375f)) * Float4::set1(4.f);
+
+        // q: 0 -> ( s,  c)  1 -> ( c, -s)  2 -> (-s, -c)  3 -> (-c,  s)
+        const Float4 zero   = Float4::set1(0.f);
+        const Float4 swap   = (q == Float4::set1(1.f)) | (q == Float4::set1(3.f));
+        const Float4 negSin = q >= Float4::set1(2.f);
+        const Float4 negCos = (q == Float4::set1(1.f)) | (q == Float4::set1(2.f));
+
+        const Float4 sinR = select(swap, c, s);
+        const Float4 cosR = select(swap, s, c);
+        outSin = select(negSin, zero - sinR, sinR);
+        outCos = select(negCos, zero - cosR, cosR);
+    }
+}
@@ -11,6 +11,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <TLib/Containers/Vector.hpp>
 #include <codecvt>
+#include <string_view>
 
 using String       = std::string;
 using StringStream = std::stringstream;
@@ -31,6 +32,47 @@ namespace strhelp
         return ws;
     }
 
+    static inline constexpr char32_t replacementChar = 0xFFFD;
+
+    /*
+    Decodes the UTF-8 code point at it and moves it past it, without allocating.
+    Malformed sequences, surrogates and overlong encodings decode to replacementChar one byte at a time,
+    so a bad byte never swallows the text after it.
+    */
+    static inline char32_t decodeUtf8(const char*& it, const char* end)
+    {
+        const auto lead = static_cast<uint8_t>(*it++);
+        if (lead < 0x80) { return lead; }
+
+        int      extra;
+        char32_t cp, min;
+        if      ((lead & 0xE0) == 0xC0) { extra = 1; cp = lead & 0x1F; min = 0x80;    }
+        else if ((lead & 0xF0) == 0xE0) { extra = 2; cp = lead & 0x0F; min = 0x800;   }
+        else if ((lead & 0xF8) == 0xF0) { extra = 3; cp = lead & 0x07; min = 0x10000; }
+        else                            { return replacementChar; }
+
+        if (end - it < extra) { return replacementChar; }
+        for (int i = 0; i < extra; i++)
+        {
+            const auto cont = static_cast<uint8_t>(it[i]);
+            if ((cont & 0xC0) != 0x80) { return replacementChar; }
+            cp = (cp << 6) | (cont & 0x3F);
+        }
+
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) { return replacementChar; }
+        it += extra;
+        return cp;
+    }
+
+    // Calls fn(char32_t) for every code point of a UTF-8 string, see decodeUtf8()
+    template <typename Fn>
+    static inline void forEachCodePoint(std::string_view str, Fn&& fn)
+    {
+        const char* it  = str.data();
+        const char* end = it + str.size();
+        while (it != end) { fn(decodeUtf8(it, end)); }
+    }
+
     template <typename StrT>
     static inline Vector<StrT> split(StrT src, const StrT& delimiter)
     {
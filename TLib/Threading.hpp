@@ -1,6 +1,10 @@
 #pragma once
 
 #include "NonAssignable.hpp"
+#include "Containers/Vector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
@@ -71,4 +75,124 @@ struct OptionalLockGuard : NonAssignable
 template <typename T>
 using Atomic = std::atomic<T>;
 
-using Thread = std::thread;
\ No newline at end of file
+using Thread = std::thread;
+
+/*
+Threads that are kept around to split loops across cores, see parallelFor().
+Only one thread at a time should call parallelFor() on a pool.
+*/
+struct ThreadPool : NonAssignable
+{
+    // One thread per core, minus the one calling parallelFor()
+    static size_t defaultThreadCount()
+    {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    explicit ThreadPool(size_t threadCount = defaultThreadCount())
+    {
+        for (size_t i = 0; i < threadCount; i++)
+        { threads.emplace_back([this]() { workerLoop(); }); }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (Thread& thread : threads) { thread.join(); }
+    }
+
+    [[nodiscard]] size_t threadCount() const { return threads.size(); }
+
+    /*
+    Calls fn(begin, end) on chunks of [0, count), at least minChunk long, from the pool's threads and the calling one.
+    Returns once every chunk is done.
+    */
+    template <typename Fn>
+    void parallelFor(size_t count, size_t minChunk, Fn&& fn)
+    {
+        if (count == 0) { return; }
+
+        // A few chunks per thread so threads that finish early can pick up more
+        const size_t chunk = std::max<size_t>({ minChunk, 1, count / ((threads.size() + 1) * 4) });
+        if (threads.empty() || count <= chunk)
+        {
+            fn(size_t(0), count);
+            return;
+        }
+
+        Job job;
+        job.fn    = [](void* ctx, size_t begin, size_t end) { (*static_cast<std::remove_reference_t<Fn>*>(ctx))(begin, end); };
+        job.ctx   = &fn;
+        job.count = count;
+        job.chunk = chunk;
+
+        {
+            std::lock_guard lock(mutex);
+            current = &job;
+            busy    = threads.size();
+            ++generation;
+        }
+        wake.notify_all();
+
+        runJob(job);
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this]() { return busy == 0; });
+        current = nullptr;
+    }
+
+private:
+    struct Job
+    {
+        void   (*fn)(void* ctx, size_t begin, size_t end) = nullptr;
+        void*  ctx   = nullptr;
+        size_t count = 0;
+        size_t chunk = 0;
+        std::atomic<size_t> next = 0;
+    };
+
+    Vector<Thread>          threads;
+    std::mutex              mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Job*                    current    = nullptr;
+    size_t                  generation = 0;
+    size_t                  busy       = 0; // Threads that haven't finished the current job
+    bool                    stopping   = false;
+
+    static void runJob(Job& job)
+    {
+        while (true)
+        {
+            const size_t begin = job.next.fetch_add(job.chunk);
+            if (begin >= job.count) { return; }
+            job.fn(job.ctx, begin, std::min(begin + job.chunk, job.count));
+        }
+    }
+
+    void workerLoop()
+    {
+        size_t seen = 0;
+        while (true)
+        {
+            Job* job;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) { return; }
+                seen = generation;
+                job  = current;
+            }
+
+            runJob(*job);
+
+            std::lock_guard lock(mutex);
+            if (--busy == 0) { done.notify_one(); }
+        }
+    }
+};
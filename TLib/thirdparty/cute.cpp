@@ -0,0 +1,6 @@
+#include <climits> // cute_spritebatch.h uses INT_MAX without including it
+
+#define CUTE_TILED_IMPLEMENTATION
+#define CUTE_ASEPRITE_IMPLEMENTATION
+#define SPRITEBATCH_IMPLEMENTATION
+#include "cute.hpp"
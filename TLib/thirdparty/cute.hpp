@@ -0,0 +1,5 @@
+#pragma once
+
+#include <TLib/thirdparty/cute_headers/cute_tiled.h>
+#include <TLib/thirdparty/cute_headers/cute_aseprite.h>
+#include <TLib/thirdparty/cute_headers/cute_spritebatch.h>
@@ -295,7 +295,7 @@ Controls:
     Shift + Left Click  : Set Start Position
     Shift + Right Click : Set End Position
 )";
-        Renderer2D::drawText(controlsText, uiFont, Vector2f(20, 20));
+        Renderer2D::drawText(controlsText, uiFont, Vector2f(20, 20), ColorRGBAf::white(), 1.f, Renderer2D::DefaultTextLayer, false);
         Renderer2D::render(false, true);
 
         drawDiagWidget(&fpslimit);
@@ -0,0 +1,91 @@
+#include <TLib/Types/Types.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Media/Resource/AsepriteSprite.hpp>
+#include "Common.hpp"
+
+// walker.ase is 16x16 with 8 frames. The top row is red, the bottom row blue and an arrow points at the top left,
+// so a frame drawn upside down or mirrored stands out. The green bar under the body counts the frame.
+// Frame 7 is a linked cel of frame 0, so the atlas holds 7 frames.
+struct AsepriteTest : GameTest
+{
+    AsepriteSprite sprite;
+
+    float time   = 0.f;
+    float speed  = 1.f;
+    float scale  = 8.f;
+    bool  paused = false;
+    bool  flipX  = false;
+
+    void create() override
+    {
+        GameTest::create();
+        window.setTitle("Aseprite Sprite");
+        sprite.loadFromFile("assets/walker.ase");
+    }
+
+    void mainLoop(float delta) override
+    {
+        GameTest::mainLoop(delta);
+        imgui.newFrame();
+
+        auto view = Renderer2D::getView();
+        debugCamera(view);
+        Renderer2D::setView(view);
+
+        Renderer::clearColor();
+
+        if (!paused) { time += delta * speed; }
+
+        const Vector2f frameSize = Vector2f(sprite.getSize()) * scale;
+        if (sprite.valid())
+        {
+            // Every tag side by side, then the whole sprite
+            float x = 100.f;
+            for (const AsepriteTag& tag : sprite.getTags())
+            {
+                const uint32_t frame = sprite.frameAt(tag, time);
+                Renderer2D::drawTexture(sprite.getFrame(frame), Rectf(Vector2f(x, 300.f), frameSize),
+                                        0.f, ColorRGBAf::white(), Renderer2D::DefaultSpriteLayer, Renderer2D::OriginCenter, flipX);
+                x += frameSize.x + 40.f;
+            }
+            Renderer2D::drawTexture(sprite.getFrame(sprite.frameAt(time)), Rectf(Vector2f(x, 300.f), frameSize),
+                                    0.f, ColorRGBAf::white(), Renderer2D::DefaultSpriteLayer, Renderer2D::OriginCenter, flipX);
+
+            // The atlas as it is, the frames should have a texel of empty space around them
+            Texture&       atlas     = sprite.getAtlas();
+            const Vector2f atlasSize = Vector2f(atlas.getSize()) * scale;
+            Renderer2D::drawRect(Rectf(Vector2f(100.f, 280.f - atlasSize.y), atlasSize));
+            Renderer2D::drawTexture(atlas, Rectf(Vector2f(100.f, 280.f - atlasSize.y), atlasSize));
+        }
+
+        Renderer2D::render();
+
+        beginDiagWidgetExt();
+        ImGui::Text("Frames: %d, tags: %d", int(sprite.frameCount()), int(sprite.getTags().size()));
+        for (const AsepriteTag& tag : sprite.getTags())
+        {
+            static constexpr const char* directions[] = { "Forwards", "Backwards", "Ping pong", "Ping pong reverse" };
+            ImGui::Text("%s (%s, %u ms): frame %u", tag.name.c_str(), directions[int(tag.direction)],
+                        sprite.getTagDuration(tag), sprite.valid() ? sprite.frameAt(tag, time) : 0);
+        }
+        ImGui::Checkbox   ("Paused", &paused);
+        ImGui::SliderFloat("Speed", &speed, 0.f, 4.f);
+        ImGui::SliderFloat("Scale", &scale, 1.f, 16.f);
+        ImGui::Checkbox   ("Flip X", &flipX);
+        ImGui::End();
+        drawDiagWidget(&fpslimit);
+
+        imgui.render();
+
+        window.swap();
+        fpslimit.wait();
+    }
+};
+
+int main()
+{
+    AsepriteTest game;
+    game.create();
+    game.run();
+    return 0;
+}
@@ -65,6 +65,10 @@ int main()
 
         Renderer::clearColor();
 
+        // Before drawing, draw calls are culled against the view that's set when they're made
+        debugCamera(camera);
+        Renderer2D::setView(camera);
+
         // Update/Draw Here
         static bool currentColor = false;
         for (size_t x = 0; x < rectCount; x++)
@@ -81,11 +85,8 @@ int main()
 
         const Vector2f mouseLocalPos = Vector2f(Input::mousePos);
         const Vector2f mouseWorldPos = getMousePos();
-        Renderer2D::drawCircle(mouseLocalPos, 3.f, 1, ColorRGBAf::red(),       true);
-        Renderer2D::drawCircle(mouseWorldPos, 3.f, 1, ColorRGBAf::steelBlue(), true);
-
-        debugCamera(camera);
-        Renderer2D::setView(camera);
+        Renderer2D::drawCircle(mouseLocalPos, 3.f, true, ColorRGBAf::red());
+        Renderer2D::drawCircle(mouseWorldPos, 3.f, true, ColorRGBAf::steelBlue());
         Renderer2D::render();
 
         imgui.newFrame();
@@ -39,6 +39,10 @@ int main()
     Vector2f tl = {20, 20};
     Vector2f br = tl + Vector2f{100, 100};
 
+    // Drawn with Renderer2D::drawNinePatches(), as one draw command
+    int               panelCount = 0;
+    Vector<NinePatch> panels;
+
     bool running = true;
     while (running)
     {
@@ -83,9 +87,25 @@ int main()
         else
             Renderer2D::drawNinePatchTex(atlas, buttonDefault, rect, left, right, top, bottom);
 
+        panels.clear();
+        for (int i = 0; i < panelCount; i++)
+        {
+            NinePatch& panel = panels.emplace_back();
+            panel.srcRect = buttonDefault;
+            panel.dstRect = Rectf(200.f + (i % 20) * 40.f, 20.f + (i / 20) * 30.f, 36.f, 26.f);
+            panel.left    = left;
+            panel.right   = right;
+            panel.top     = top;
+            panel.bottom  = bottom;
+        }
+        Renderer2D::drawNinePatches(atlas, panels);
+
         Renderer2D::render();
 
         imgui.newFrame();
+        beginDiagWidgetExt();
+        ImGui::SliderInt("Bulk panels", &panelCount, 0, 400);
+        ImGui::End();
         drawDiagWidget(&fpslimit);
         imgui.render();
 
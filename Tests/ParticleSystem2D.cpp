@@ -0,0 +1,92 @@
+#include <TLib/Types/Types.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Media/ParticleSystem2D.hpp>
+#include "Common.hpp"
+
+struct ParticleTest : GameTest
+{
+    Texture           tex;
+    ParticleSystem2D  particles;
+    ParticleEmitter2D fountain;
+
+    int   maxParticles = 500000;
+    float gravity      = -200.f;
+    bool  useTexture   = true;
+
+    void create() override
+    {
+        GameTest::create();
+        window.setTitle("Particle System 2D");
+        tex.loadFromFile("assets/ship.png");
+
+        fountain.angle       = 3.1415926f / 2.f;
+        fountain.angleSpread = 0.4f;
+        fountain.speedMin    = 150.f;
+        fountain.speedMax    = 400.f;
+        fountain.lifeMin     = 1.f;
+        fountain.lifeMax     = 3.f;
+        fountain.spinMin     = -4.f;
+        fountain.spinMax     = 4.f;
+        fountain.rate        = 200000.f;
+        createParticles();
+    }
+
+    void createParticles()
+    {
+        ParticleSystem2DSettings settings;
+        settings.texture       = useTexture ? &tex : nullptr;
+        settings.maxParticles  = maxParticles;
+        settings.acceleration  = { 0.f, gravity };
+        settings.drag          = 0.2f;
+        settings.sizeOverLife  = { { 0.f, 0.2f }, { 0.1f, 1.f }, { 1.f, 0.5f } };
+        settings.colorOverLife = { { 0.f, ColorRGBAf::yellow() }, { 0.5f, ColorRGBAf::orange() }, { 1.f, ColorRGBAf::transparent() } };
+        particles.create(settings);
+    }
+
+    void mainLoop(float delta) override
+    {
+        GameTest::mainLoop(delta);
+        imgui.newFrame();
+
+        auto view = Renderer2D::getView();
+        debugCamera(view);
+        Renderer2D::setView(view);
+
+        Renderer::clearColor();
+
+        fountain.pos = getMousePos();
+        particles.emit(fountain, delta);
+        particles.update(delta);
+        particles.draw();
+        Renderer2D::render();
+
+        beginDiagWidgetExt();
+        ImGui::Text("Particles: %d", int(particles.particleCount()));
+        ImGui::SliderFloat("Emitted per second", &fountain.rate, 0.f, 500000.f);
+        ImGui::SliderFloat("Spread", &fountain.angleSpread, 0.f, 3.1415926f);
+        // These restart the effect, only do it once the slider is let go
+        ImGui::SliderInt("Max particles", &maxParticles, 1000, 1000000);
+        if (ImGui::IsItemDeactivatedAfterEdit()) { createParticles(); }
+        ImGui::SliderFloat("Gravity", &gravity, -1000.f, 1000.f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) { createParticles(); }
+        if (ImGui::Checkbox("Textured", &useTexture)) { createParticles(); }
+        bool instancing = Renderer2D::isInstancingEnabled();
+        if (ImGui::Checkbox("Instancing", &instancing))
+        { Renderer2D::setInstancingEnabled(instancing); }
+        ImGui::End();
+        drawDiagWidget(&fpslimit);
+
+        imgui.render();
+
+        window.swap();
+        fpslimit.wait();
+    }
+};
+
+int main()
+{
+    ParticleTest game;
+    game.create();
+    game.run();
+    return 0;
+}
@@ -12,10 +12,28 @@ struct SpriteTest : GameTest
     Font    sdfFont;
     Font    bitmapFont;
 
+    // Small textures that only batch together when auto atlasing is on, see Renderer2D::setAutoAtlasEnabled()
+    Vector<Texture> looseTextures;
+
     bool  rotationEnabled   = true;
+    bool  bulkEnabled       = false;
+    bool  looseEnabled      = false;
+    bool  shapesEnabled     = false;
+    bool  polygonsEnabled   = false;
+    int   polygonCount      = 2000;
+
+    // A concave cog with a hole in the middle, drawn with Renderer2D::drawFilledPolygon()
+    Vector<Vector2f> cogPoints;
+    Vector<uint32_t> cogHoles;
+    Vector<SpriteInstance> sprites;
     int   spriteCount       = 30;
     float offset            = 32;
 
+    // Sprites are drawn from this many threads when it isn't 0, see Renderer2D::beginCommandList()
+    int   workerCount       = 0;
+    Vector<Renderer2D::CommandList> commandLists;
+    Vector<Vector<SpriteInstance>>  workerSprites;
+
     void create() override
     {
         GameTest::create();
@@ -24,6 +42,83 @@ struct SpriteTest : GameTest
         tex.setFilter(TextureFiltering::Nearest);
         sdfFont.loadFromFile("assets/roboto.ttf", 24);
         bitmapFont.loadFromFile("assets/roboto.ttf", 24, 0, 128, FontRenderMode::Normal);
+        makeLooseTextures();
+        makeCog();
+    }
+
+    void makeCog()
+    {
+        const int teeth = 12;
+        for (int i = 0; i < teeth * 4; i++)
+        {
+            const float angle  = float(i) / float(teeth * 4) * 6.2831853f;
+            const float radius = i % 4 < 2 ? 16.f : 11.f;
+            cogPoints.push_back(Vector2f(std::cos(angle), std::sin(angle)) * radius);
+        }
+        cogHoles.push_back(uint32_t(cogPoints.size()));
+        cogPoints.insert(cogPoints.end(), { { -4.f, -4.f }, { -4.f, 4.f }, { 4.f, 4.f }, { 4.f, -4.f } });
+    }
+
+    // 16x16 checkers, each in its own color
+    void makeLooseTextures()
+    {
+        looseTextures.resize(24);
+        for (size_t i = 0; i < looseTextures.size(); i++)
+        {
+            const uint8_t r = uint8_t(80 + i * 40), g = uint8_t(255 - i * 10), b = uint8_t(i * 90);
+            Vector<uint8_t> pixels;
+            for (int y = 0; y < 16; y++)
+            {
+                for (int x = 0; x < 16; x++)
+                {
+                    const bool dark = ((x / 4) + (y / 4)) % 2;
+                    pixels.insert(pixels.end(), { dark ? uint8_t(r / 2) : r, dark ? uint8_t(g / 2) : g, dark ? uint8_t(b / 2) : b, 255 });
+                }
+            }
+            looseTextures[i].setData(pixels.data(), 16, 16);
+            looseTextures[i].setFilter(TextureMinFilter::Nearest, TextureMagFilter::Nearest);
+        }
+    }
+
+    // Draws columns [xBegin, xEnd) of the sprite grid
+    void drawSprites(int xBegin, int xEnd, float time, Vector<SpriteInstance>& bulk)
+    {
+        const int sr = std::ceil(sqrt(spriteCount));
+
+        for (int x = xBegin; x < xEnd; x++)
+        {
+            for (int y = 0; y < sr; y++)
+            {
+                if (x * sr + y >= spriteCount) { break; }
+
+                const float rot = rotationEnabled ? sin(time) * x + y : 0;
+                const ColorRGBAf color =
+                {
+                    fmodf(sin(time), 1.f) * (y%16),
+                    fmodf(cos(time / 2.f) * (x%12), 1.f),
+                    fmodf((time)+x+y, 1.f), 1.f
+                };
+                const Rectf rect = { Vector2f(x, y) * offset, Vector2f(32,32) };
+
+                if (bulkEnabled)
+                {
+                    SpriteInstance& sprite = bulk.emplace_back();
+                    sprite.pos      = rect.getPos() + rect.getSize() / 2.f;
+                    sprite.size     = rect.getSize();
+                    sprite.srcrect  = Rectf(0.f, 0.f, Vector2f(tex.getSize()));
+                    sprite.rotation = rot;
+                    sprite.color    = color;
+                }
+                else
+                {
+                    Texture& t = looseEnabled ? looseTextures[(x + y) % looseTextures.size()] : tex;
+                    Renderer2D::drawTexture(t, rect, rot, color, 0);
+                }
+            }
+        }
+
+        Renderer2D::drawTextures(tex, bulk);
+        bulk.clear();
     }
 
     void mainLoop(float delta) override
@@ -41,33 +136,59 @@ struct SpriteTest : GameTest
 
         static float time = 0.f;
         time += delta;
-        int count = spriteCount;
-        int sr = std::ceil(sqrt(spriteCount));
+        const int sr = std::ceil(sqrt(spriteCount));
 
-        for (int x = 0; x < sr; x++)
+        if (workerCount == 0)
+        { drawSprites(0, sr, time, sprites); }
+        else
         {
-            for (int y = 0; y < sr; y++)
+            commandLists .resize(workerCount);
+            workerSprites.resize(workerCount);
+
+            Vector<Thread> workers;
+            for (int i = 0; i < workerCount; i++)
             {
-                const float rot = rotationEnabled ? sin(time) * x + y : 0;
-                const ColorRGBAf color =
+                workers.emplace_back([&, i]()
                 {
-                    fmodf(sin(time), 1.f) * (y%16),
-                    fmodf(cos(time / 2.f) * (x%12), 1.f),
-                    fmodf((time)+x+y, 1.f), 1.f
-                };
-                const Rectf rect = { Vector2f(x, y) * offset, Vector2f(32,32) };
-
-                Renderer2D::drawTexture(tex, rect, rot, color, 0);
-                --count;
-                if (count == 0) break;
+                    Renderer2D::beginCommandList(commandLists[i]);
+                    drawSprites(sr * i / workerCount, sr * (i + 1) / workerCount, time, workerSprites[i]);
+                    Renderer2D::endCommandList();
+                });
             }
-            if (count == 0) break;
+
+            for (auto& worker : workers)    { worker.join(); }
+            for (auto& list : commandLists) { Renderer2D::submitCommandList(list); }
         }
 
         Renderer2D::drawCircle(mwpos, 12.f);
         Renderer2D::drawCircle(mwpos + Vector2f(20, 20), 12.f);
         Renderer2D::drawCircle({0, 0}, 6.f);
         Renderer2D::drawRect({ mwpos, Vector2f(20, 20) });
+
+        // One quad each, see Renderer2D::drawCircle()
+        if (shapesEnabled)
+        {
+            const float spin = rotationEnabled ? time : 0.f;
+            for (int i = 0; i < 8; i++)
+            {
+                const Vector2f  pos(100.f + float(i) * 90.f, 300.f);
+                const ColorRGBAf color(0.3f + 0.1f * float(i), 0.6f, 1.f - 0.1f * float(i), 0.8f);
+                Renderer2D::drawCircle     (pos, 4.f + float(i) * 4.f, i % 2 == 0, color);
+                Renderer2D::drawRing       (pos + Vector2f(0.f, 100.f), 36.f, 1.f + float(i) * 3.f, color);
+                Renderer2D::drawRoundedRect({ pos + Vector2f(-35.f, 160.f), Vector2f(70.f, 50.f) }, float(i) * 4.f, spin, i % 2 == 1, color);
+                Renderer2D::drawCapsule    (pos + Vector2f(-30.f, 270.f), pos + Vector2f(30.f, 270.f + float(i) * 6.f), 10.f, i % 2 == 0, color);
+            }
+        }
+        // Tessellated once, then moved and rotated, see Renderer2D::setPolygonCacheEnabled()
+        if (polygonsEnabled)
+        {
+            const float spin = rotationEnabled ? time : 0.f;
+            for (int i = 0; i < polygonCount; i++)
+            {
+                const Vector2f pos(float(i % 50) * 36.f, -100.f - float(i / 50) * 36.f);
+                Renderer2D::drawFilledPolygon(cogPoints, cogHoles, pos, spin + float(i), ColorRGBAf(0.9f, 0.7f, 0.3f));
+            }
+        }
         Renderer2D::drawText("Hello world!", sdfFont,    { 50, 50 });
         Renderer2D::drawText("Hello world!", bitmapFont, { 50, 50 + float(bitmapFont.lineSpacing()) });
 
@@ -78,7 +199,44 @@ struct SpriteTest : GameTest
 
         beginDiagWidgetExt();
         ImGui::Checkbox    ("Rotation enabled", &rotationEnabled);
+        ImGui::Checkbox    ("Bulk submission", &bulkEnabled);
+        ImGui::Checkbox    ("Loose textures", &looseEnabled);
+        ImGui::Checkbox    ("Shapes", &shapesEnabled);
+        ImGui::Checkbox    ("Concave polygons", &polygonsEnabled);
+        ImGui::SliderInt   ("Polygon count", &polygonCount, 1, 10000);
+
+        bool polygonCache = Renderer2D::isPolygonCacheEnabled();
+        if (ImGui::Checkbox("Polygon cache", &polygonCache))
+        { Renderer2D::setPolygonCacheEnabled(polygonCache); }
+
+        bool autoAtlas = Renderer2D::isAutoAtlasEnabled();
+        if (ImGui::Checkbox("Auto atlas", &autoAtlas))
+        {
+            TextureAutoAtlasSettings settings;
+            settings.filter = TextureMagFilter::Nearest; // Like the test's textures
+            Renderer2D::setAutoAtlasEnabled(autoAtlas, settings);
+        }
+        ImGui::SameLine();
+        ImGui::Text("%d atlases", int(Renderer2D::getAutoAtlasCount()));
+
+        bool instancing = Renderer2D::isInstancingEnabled();
+        if (ImGui::Checkbox("Instancing", &instancing))
+        { Renderer2D::setInstancingEnabled(instancing); }
+
+        bool culling = Renderer2D::isCullingEnabled();
+        if (ImGui::Checkbox("Culling", &culling))
+        { Renderer2D::setCullingEnabled(culling); }
+
+        bool parallelBuild = Renderer2D::isParallelBuildEnabled();
+        if (ImGui::Checkbox("Parallel build", &parallelBuild))
+        { Renderer2D::setParallelBuildEnabled(parallelBuild); }
+
+        int framesInFlight = Renderer::getFramesInFlight();
+        if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, GPUVertexData::maxStreamFrames))
+        { Renderer::setFramesInFlight(framesInFlight); }
+
         ImGui::SliderInt   ("Sprite count", &spriteCount, 1, 20000);
+        ImGui::SliderInt   ("Worker threads", &workerCount, 0, 16);
         ImGui::SliderFloat ("Sprite offset", &offset, 1.f, 128.f, "%.2f");
 
         if (ImGui::SliderFloat("Text Width", &tempWidth, 0.0f, 1.f))
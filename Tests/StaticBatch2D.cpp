@@ -0,0 +1,89 @@
+#include <TLib/Types/Types.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Media/StaticBatch2D.hpp>
+#include "Common.hpp"
+
+struct StaticBatchTest : GameTest
+{
+    Texture       tex;
+    Font          font;
+    StaticBatch2D level;
+
+    bool  useStaticBatch = true;
+    int   gridSize       = 200;
+    float offset         = 34;
+
+    void create() override
+    {
+        GameTest::create();
+        window.setTitle("Static Batch 2D");
+        tex.loadFromFile("assets/ship.png");
+        tex.setFilter(TextureFiltering::Nearest);
+        font.loadFromFile("assets/roboto.ttf", 24);
+        recordLevel();
+    }
+
+    // The "level" doesn't move, so it only has to be built once
+    void drawLevel()
+    {
+        for (int x = 0; x < gridSize; x++)
+        {
+            for (int y = 0; y < gridSize; y++)
+            {
+                const ColorRGBAf color = { float(x % 8) / 8.f, float(y % 8) / 8.f, 1.f, 1.f };
+                const Rectf      rect  = { Vector2f(x, y) * offset, Vector2f(32, 32) };
+                Renderer2D::drawTexture(tex, rect, float(x + y) * 0.1f, color);
+            }
+        }
+
+        Renderer2D::drawRect(Rectf(0.f, 0.f, Vector2f(float(gridSize) * offset)), 0.f, false, ColorRGBAf::red());
+        Renderer2D::drawText("Recorded once", font, { 50, 50 });
+    }
+
+    void recordLevel()
+    {
+        level.begin();
+        drawLevel();
+        level.end();
+    }
+
+    void mainLoop(float delta) override
+    {
+        GameTest::mainLoop(delta);
+        imgui.newFrame();
+
+        auto view = Renderer2D::getView();
+        debugCamera(view);
+        Renderer2D::setView(view);
+
+        Renderer::clearColor();
+
+        if (useStaticBatch) { level.draw(); }
+        else                { drawLevel();  }
+
+        // Dynamic sprites still go through the usual path, on top of the level
+        Renderer2D::drawCircle(getMousePos(), 12.f);
+        Renderer2D::render();
+
+        beginDiagWidgetExt();
+        ImGui::Checkbox("Use static batch", &useStaticBatch);
+        if (ImGui::SliderInt("Grid size", &gridSize, 1, 500))
+        { recordLevel(); }
+        ImGui::Text("Static batch draw calls: %d", int(level.batchCount()));
+        ImGui::End();
+        drawDiagWidget(&fpslimit);
+
+        imgui.render();
+
+        window.swap();
+        fpslimit.wait();
+    }
+};
+
+int main()
+{
+    StaticBatchTest game;
+    game.create();
+    game.run();
+    return 0;
+}
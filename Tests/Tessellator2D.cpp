@@ -0,0 +1,204 @@
+#include <TLib/Types/Types.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Media/Tessellator2D.hpp>
+#include "Common.hpp"
+#include <random>
+
+// Signed, positive when counter clockwise
+double ringArea(std::span<const Vector2f> ring)
+{
+    double area = 0.0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    { area += double(ring[j].x) * ring[i].y - double(ring[i].x) * ring[j].y; }
+    return area / 2.0;
+}
+
+double trianglesArea(std::span<const Vector2f> points, std::span<const uint32_t> indices)
+{
+    double area = 0.0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const Vector2f a = points[indices[i]], b = points[indices[i + 1]], c = points[indices[i + 2]];
+        area += std::abs((double(b.x) - a.x) * (double(c.y) - a.y) - (double(c.x) - a.x) * (double(b.y) - a.y)) / 2.0;
+    }
+    return area;
+}
+
+// A polygon and its triangles, which have to cover the outline less the holes and nothing else
+struct TessCase
+{
+    const char*      name = "";
+    Vector<Vector2f> points;
+    Vector<uint32_t> holeStarts;
+    Vector<uint32_t> indices;
+    double           area     = 0.0;
+    double           expected = 0.0;
+    bool             passed   = false;
+};
+
+struct TessellatorTest : GameTest
+{
+    Tessellator2D    tess;
+    Vector<TessCase> cases;
+    Vector<TessCase> randomCases;
+
+    int   failures      = 0;
+    int   randomShown   = 0;
+    float rotation      = 0.f;
+    bool  showTriangles = true;
+
+    void check(TessCase& c)
+    {
+        c.indices.clear();
+        tess.triangulate(c.points, c.holeStarts, c.indices);
+
+        c.expected = 0.0;
+        for (size_t ring = 0; ring <= c.holeStarts.size(); ++ring)
+        {
+            const size_t begin = ring == 0 ? 0 : c.holeStarts[ring - 1];
+            const size_t end   = ring == c.holeStarts.size() ? c.points.size() : c.holeStarts[ring];
+            if (end - begin < 3) { continue; }
+            const double area = std::abs(ringArea(std::span(c.points).subspan(begin, end - begin)));
+            c.expected += ring == 0 ? area : -area;
+        }
+        c.area   = trianglesArea(c.points, c.indices);
+        c.passed = std::abs(c.area - c.expected) <= 1e-3 * std::max(1.0, c.expected);
+        if (!c.passed)
+        {
+            tlog::error("{}: the triangles cover {}, the polygon {}", c.name, c.area, c.expected);
+            ++failures;
+        }
+    }
+
+    void add(const char* name, Vector<Vector2f> points, Vector<uint32_t> holeStarts = {})
+    {
+        TessCase& c  = cases.emplace_back();
+        c.name       = name;
+        c.points     = std::move(points);
+        c.holeStarts = std::move(holeStarts);
+        check(c);
+    }
+
+    static Vector2f polar(float radius, float angle)
+    { return { radius * std::cos(angle), radius * std::sin(angle) }; }
+
+    void create() override
+    {
+        GameTest::create();
+        window.setTitle("Tessellator 2D");
+
+        constexpr float tau = 6.2831853f;
+        add("Square",     { { 0, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 } });
+        add("Square CW",  { { 0, 0 }, { 0, 100 }, { 100, 100 }, { 100, 0 } });
+        add("L",          { { 0, 0 }, { 100, 0 }, { 100, 50 }, { 50, 50 }, { 50, 100 }, { 0, 100 } });
+        add("Hole",       { { 0, 0 }, { 120, 0 }, { 120, 120 }, { 0, 120 }, { 30, 30 }, { 90, 30 }, { 90, 90 }, { 30, 90 } }, { 4 });
+        add("Hole CCW",   { { 0, 0 }, { 120, 0 }, { 120, 120 }, { 0, 120 }, { 30, 30 }, { 30, 90 }, { 90, 90 }, { 90, 30 } }, { 4 });
+        add("Two holes",  { { 0, 0 }, { 150, 0 }, { 150, 60 }, { 0, 60 },
+                            { 15, 15 }, { 45, 15 }, { 45, 45 }, { 15, 45 },
+                            { 90, 15 }, { 120, 15 }, { 120, 45 }, { 90, 45 } }, { 4, 8 });
+        add("Triangle",   { { 0, 0 }, { 100, 0 }, { 0, 100 } });
+        add("Collinear",  { { 0, 0 }, { 50, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 } });
+        add("Degenerate", { { 0, 0 }, { 100, 0 } });
+
+        // Teeth pointing up, every notch is a reflex corner
+        Vector<Vector2f> comb = { { 0, 0 }, { 150, 0 }, { 150, 45 } };
+        for (int i = 9; i >= 0; --i)
+        {
+            comb.push_back({ (i + 0.5f) * 15.f, 15.f });
+            comb.push_back({ i * 15.f, 45.f });
+        }
+        add("Comb", std::move(comb));
+
+        Vector<Vector2f> star;
+        for (int i = 0; i < 10; ++i) { star.push_back(polar(i % 2 ? 20.f : 60.f, i * tau / 10.f)); }
+        add("Star", std::move(star));
+
+        // A cog with a round hole, the teeth alternate between two radii
+        Vector<Vector2f> cog;
+        for (int i = 0; i < 48; ++i) { cog.push_back(polar((i / 2) % 2 ? 45.f : 60.f, i * tau / 48.f)); }
+        const uint32_t cogHole = uint32_t(cog.size());
+        for (int i = 0; i < 24; ++i) { cog.push_back(polar(20.f, -i * tau / 24.f)); }
+        add("Cog", std::move(cog), { cogHole });
+
+        // Random star shaped outlines around a small hole
+        std::mt19937                          rng(1);
+        std::uniform_real_distribution<float> radius(25.f, 70.f);
+        for (int i = 0; i < 200; ++i)
+        {
+            TessCase& c = randomCases.emplace_back();
+            c.name      = "Random";
+            const int n = 5 + int(rng() % 200);
+            for (int p = 0; p < n; ++p) { c.points.push_back(polar(radius(rng), p * tau / n)); }
+            c.holeStarts.push_back(uint32_t(c.points.size()));
+            for (int p = 0; p < 8; ++p) { c.points.push_back(polar(10.f, -p * tau / 8.f)); }
+            check(c);
+        }
+
+        tlog::info("Tessellator2D: {} of {} polygons failed", failures, int(cases.size() + randomCases.size()));
+    }
+
+    void drawCase(const TessCase& c, const Vector2f& pos)
+    {
+        const ColorRGBAf color = c.passed ? ColorRGBAf::green() : ColorRGBAf::red();
+        Renderer2D::drawFilledPolygon(c.points, c.holeStarts, pos, rotation, color);
+        if (!showTriangles) { return; }
+
+        const float cos = std::cos(rotation), sin = std::sin(rotation);
+        auto world = [&](uint32_t i) { const Vector2f& p = c.points[i]; return pos + Vector2f(p.x * cos - p.y * sin, p.x * sin + p.y * cos); };
+        for (size_t i = 0; i + 2 < c.indices.size(); i += 3)
+        {
+            const Vector2f a = world(c.indices[i]), b = world(c.indices[i + 1]), d = world(c.indices[i + 2]);
+            Renderer2D::drawLine(a, b, ColorRGBAf::black());
+            Renderer2D::drawLine(b, d, ColorRGBAf::black());
+            Renderer2D::drawLine(d, a, ColorRGBAf::black());
+        }
+    }
+
+    void mainLoop(float delta) override
+    {
+        GameTest::mainLoop(delta);
+        imgui.newFrame();
+
+        auto view = Renderer2D::getView();
+        debugCamera(view);
+        Renderer2D::setView(view);
+
+        Renderer::clearColor();
+
+        // A grid of the fixed cases, then the chosen random one
+        for (size_t i = 0; i < cases.size(); ++i)
+        { drawCase(cases[i], Vector2f(100.f + (i % 5) * 200.f, 550.f - (i / 5) * 200.f)); }
+        drawCase(randomCases[randomShown], Vector2f(1200.f, 350.f));
+
+        Renderer2D::render();
+
+        beginDiagWidgetExt();
+        ImGui::Text("Failed: %d of %d", failures, int(cases.size() + randomCases.size()));
+        for (const TessCase& c : cases)
+        {
+            ImGui::Text("%s: %d triangles, area %.1f of %.1f %s", c.name, int(c.indices.size() / 3),
+                        c.area, c.expected, c.passed ? "" : "FAILED");
+        }
+        ImGui::SliderInt("Random polygon", &randomShown, 0, int(randomCases.size()) - 1);
+        ImGui::SliderFloat("Rotation", &rotation, 0.f, 6.2831853f);
+        ImGui::Checkbox("Triangles", &showTriangles);
+        bool cached = Renderer2D::isPolygonCacheEnabled();
+        if (ImGui::Checkbox("Polygon cache", &cached))
+        { Renderer2D::setPolygonCacheEnabled(cached); }
+        ImGui::End();
+        drawDiagWidget(&fpslimit);
+
+        imgui.render();
+
+        window.swap();
+        fpslimit.wait();
+    }
+};
+
+int main()
+{
+    TessellatorTest game;
+    game.create();
+    game.run();
+    return game.failures == 0 ? 0 : 1;
+}
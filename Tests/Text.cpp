@@ -10,6 +10,10 @@ struct TextTest : GameTest
 {
     Font font;
 
+    // Lots of short lines, like a debug overlay
+    bool hud      = false;
+    int  hudLines = 2000;
+
     String text =
 R"(Lorem ipsum dolor sit amet, consectetur adipiscing elit.
 Suspendisse consequat urna odio, nec pellentesque augue suscipit at.
@@ -28,7 +32,7 @@ ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz123456789!@#$%^&*()-=_+\|,./
     {
         GameTest::create();
         window.setTitle("Text Test");
-        font.loadFromFile("assets/arial.ttf", 24, 0, 256);
+        font.loadFromFile("assets/arial.ttf", 24, 0, 256, FontRenderMode::SDF, TextureFiltering::Linear, "cache/arial24.font");
         font.getAtlas().writeToFile("atlas.png");
     }
 
@@ -54,12 +58,37 @@ ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz123456789!@#$%^&*()-=_+\|,./
         Rectf atlasRect(textPos - Vector2f(0, 20) - Vector2f(0, font.getAtlas().getSize().y), Vector2f(font.getAtlas().getSize()));
         Renderer2D::drawTexture(font.getAtlas(), atlasRect);
 
-        Renderer2D::drawCircle(textPos, 6.f, 1, ColorRGBAf::red(), true);
+        Renderer2D::drawCircle(textPos, 6.f, true, ColorRGBAf::red());
         Renderer2D::drawRect(Rectf(textPos, font.calcTextSize(text)), 0.f, false, ColorRGBAf::green());
         Renderer2D::drawText(text, font, textPos);
+        Renderer2D::drawText("Unicode: caf\xC3\xA9, \xE2\x82\xAC", font, textPos - Vector2f(0, 40));
+        // Outside the loaded range, rasterized the first time they're drawn
+        Renderer2D::drawText("\xCE\x95\xCE\xBB\xCE\xBB\xCE\xB7\xCE\xBD\xCE\xB9\xCE\xBA\xCE\xAC \xD0\xA0\xD1\x83\xD1\x81\xD1\x81\xD0\xBA\xD0\xB8\xD0\xB9 \xE2\x86\x90\xE2\x86\x91\xE2\x86\x92",
+                             font, textPos - Vector2f(0, 80));
         Renderer2D::drawCircle(mwpos, 12.f);
+
+        if (hud)
+        {
+            char line[64];
+            for (int i = 0; i < hudLines; i++)
+            {
+                snprintf(line, sizeof(line), "Entity %d: hp 100/100 state idle", i);
+                Renderer2D::drawText(line, font, { 1000.f + float(i / 100) * 400.f, float(i % 100) * 20.f }, ColorRGBAf::white(), 0.6f);
+            }
+        }
         Renderer2D::render();
 
+        beginDiagWidgetExt();
+        ImGui::Checkbox("HUD", &hud);
+        ImGui::SliderInt("HUD lines", &hudLines, 0, 10000);
+        bool cache = Renderer2D::isGlyphRunCacheEnabled();
+        if (ImGui::Checkbox("Glyph run cache", &cache))
+        { Renderer2D::setGlyphRunCacheEnabled(cache); }
+        bool lazy = font.isLazyGlyphsEnabled();
+        if (ImGui::Checkbox("Load glyphs as they're drawn", &lazy))
+        { font.setLazyGlyphsEnabled(lazy); }
+        ImGui::Text("Font pages: %d", int(font.pageCount()));
+        ImGui::End();
         drawDiagWidget(&fpslimit);
 
         imgui.render();
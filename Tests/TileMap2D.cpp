@@ -0,0 +1,106 @@
+#include <TLib/Types/Types.hpp>
+#include <TLib/Media/Renderer.hpp>
+#include <TLib/Media/TileMap2D.hpp>
+#include <TLib/RNG.hpp>
+#include "Common.hpp"
+
+struct TileMapTest : GameTest
+{
+    TileMap2D map;
+    RNG       rng { 1234 };
+
+    int  mapSize   = 1000;
+    int  chunkSize = TileMap2D::defaultChunkSize;
+    bool decor     = true;
+
+    void create() override
+    {
+        GameTest::create();
+        window.setTitle("Tile Map 2D");
+        generateMap();
+    }
+
+    // A Tiled JSON export, made up so the test doesn't need a map asset.
+    // ship.png is cut in 16 8x8 tiles, the decor layer flips and rotates some of them.
+    void generateMap()
+    {
+        std::string ground, top;
+        ground.reserve(size_t(mapSize) * mapSize * 3);
+        top   .reserve(size_t(mapSize) * mapSize * 3);
+
+        for (int i = 0; i < mapSize * mapSize; i++)
+        {
+            const char* sep = i > 0 ? "," : "";
+            fmt::format_to(std::back_inserter(ground), "{}{}", sep, 1 + (i * 7 + i / mapSize) % 16);
+
+            uint32_t gid = 0;
+            if (rng.randRangeInt(0, 9) == 0)
+            {
+                gid = rng.randRangeInt(1, 16);
+                if (rng.randRangeInt(0, 1)) { gid |= 0x80000000; } // Horizontal
+                if (rng.randRangeInt(0, 1)) { gid |= 0x40000000; } // Vertical
+                if (rng.randRangeInt(0, 1)) { gid |= 0x20000000; } // Diagonal
+            }
+            fmt::format_to(std::back_inserter(top), "{}{}", sep, gid);
+        }
+
+        const std::string layer =
+            R"({{"data":[{}],"width":{},"height":{},"id":{},"name":"{}","opacity":{},"type":"tilelayer","visible":true,"x":0,"y":0}})";
+
+        const std::string json = fmt::format(
+            R"({{"width":{0},"height":{0},"tilewidth":8,"tileheight":8,"infinite":false,"orientation":"orthogonal",)"
+            R"("renderorder":"right-down","type":"map","version":"1.10","nextlayerid":3,"nextobjectid":1,"layers":[{1},{2}],)"
+            R"("tilesets":[{{"columns":4,"firstgid":1,"image":"ship.png","imagewidth":32,"imageheight":32,)"
+            R"("margin":0,"spacing":0,"name":"ship","tilecount":16,"tilewidth":8,"tileheight":8}}]}})",
+            mapSize,
+            fmt::format(fmt::runtime(layer), ground, mapSize, mapSize, 1, "Ground", 1),
+            fmt::format(fmt::runtime(layer), top,    mapSize, mapSize, 2, "Decor",  0.8));
+
+        map.loadFromMemory(json.data(), json.size(), "assets", chunkSize);
+    }
+
+    void mainLoop(float delta) override
+    {
+        GameTest::mainLoop(delta);
+        imgui.newFrame();
+
+        auto view = Renderer2D::getView();
+        debugCamera(view, 0.01f);
+        Renderer2D::setView(view);
+
+        Renderer::clearColor();
+
+        if (map.valid())
+        {
+            map.setLayerVisible(1, decor);
+            map.draw();
+        }
+
+        Renderer2D::drawCircle(getMousePos(), 12.f);
+        Renderer2D::render();
+
+        beginDiagWidgetExt();
+        ImGui::Checkbox("Decor layer", &decor);
+        // Rebuilding a big map takes a moment, only do it once the slider is let go
+        ImGui::SliderInt("Map size", &mapSize, 16, 2000);
+        if (ImGui::IsItemDeactivatedAfterEdit()) { generateMap(); }
+        ImGui::SliderInt("Chunk size", &chunkSize, 4, 128);
+        if (ImGui::IsItemDeactivatedAfterEdit()) { generateMap(); }
+        ImGui::Text("Chunks drawn: %d", int(map.drawnChunkCount()));
+        ImGui::End();
+        drawDiagWidget(&fpslimit);
+
+        imgui.render();
+
+        window.swap();
+        fpslimit.wait();
+    }
+};
+
+int main()
+{
+    TileMapTest game;
+    game.create();
+    game.run();
+    return 0;
+}